@@ -0,0 +1,70 @@
+/**
+ * @file    cmd.h
+ * @brief   Terminal command dispatcher
+ * @date    17 paź 2026
+ * @author  Michal Ksiezopolski
+ *
+ * @details Commands are registered once at startup with a name,
+ * a handler and the allowed number of arguments. The table is kept
+ * sorted, so a frame is dispatched with a binary search instead of
+ * comparing it with every command. The frame is split into tokens
+ * in place - tokens point into the frame buffer and nothing is copied.
+ *
+ * Example:
+ * @code
+ * void ledHandler(uint8_t argc, const CMD_Token_TypeDef* argv);
+ * CMD_Register(":LED0", ledHandler, 1, 1);
+ * CMD_Dispatch(buf, len); // buf = ":LED0 ON"
+ * @endcode
+ *
+ * @verbatim
+ * Copyright (c) 2026 Michal Ksiezopolski.
+ * All rights reserved. This program and the
+ * accompanying materials are made available
+ * under the terms of the GNU Public License
+ * v3.0 which accompanies this distribution,
+ * and is available at
+ * http://www.gnu.org/licenses/gpl.html
+ * @endverbatim
+ */
+
+#ifndef CMD_H_
+#define CMD_H_
+
+#include <inttypes.h>
+
+/**
+ * @defgroup  CMD CMD
+ * @brief     Terminal command dispatcher.
+ */
+
+/**
+ * @addtogroup CMD
+ * @{
+ */
+
+#ifndef CMD_MAX_COMMANDS
+  #define CMD_MAX_COMMANDS  32 ///< Maximum number of registered commands (max 255)
+#endif
+
+#define CMD_MAX_ARGS      8  ///< Maximum number of arguments of a command
+
+/**
+ * @brief Token of a frame (not null terminated).
+ */
+typedef struct {
+  const char* str;  ///< First character (points into frame buffer)
+  uint16_t    len;  ///< Length
+} CMD_Token_TypeDef;
+
+uint8_t CMD_Register(const char* name,
+    void (*handler)(uint8_t argc, const CMD_Token_TypeDef* argv),
+    uint8_t minArgs, uint8_t maxArgs);
+uint8_t CMD_Dispatch(const char* buf, uint16_t len);
+uint8_t CMD_TokenEquals(const CMD_Token_TypeDef* token, const char* str);
+
+/**
+ * @}
+ */
+
+#endif /* CMD_H_ */
@@ -19,6 +19,9 @@
 #define COMM_H_
 
 #include <inttypes.h>
+#include <stdarg.h>
+#include <fifo.h>
+#include <fifo_typed.h>
 
 /**
  * @defgroup  COMM COMM
@@ -30,10 +33,82 @@
  * @{
  */
 
+#define COMM_MAX_FRAME_LEN 254   ///< Maximum frame length (without terminator)
+#define COMM_MAX_FRAMES    16    ///< Maximum number of frames waiting in RX FIFO
+
+/**
+ * @brief View of a received frame inside the RX buffer.
+ * @details The frame may wrap around the end of the buffer,
+ * then it is split in two parts.
+ */
+typedef struct {
+  const uint8_t* data[2]; ///< Parts of the frame
+  uint16_t len[2];        ///< Lengths of the parts (second may be 0)
+} COMM_FrameView_TypeDef;
+
+/**
+ * @brief Position of a received frame in the RX FIFO.
+ */
+typedef struct {
+  uint16_t start; ///< RX FIFO index of the first byte
+  uint16_t len;   ///< Number of bytes stored in RX FIFO (with terminator)
+  uint8_t  error; ///< Nonzero if frame was too long or bytes were lost
+} COMM_Frame_TypeDef;
+
+FIFO_TYPED_DEFINE(COMM_FRAMES, COMM_Frame_TypeDef, COMM_MAX_FRAMES)
+
+/**
+ * @brief COMM port.
+ * @details Fill in the fields marked as set by user and
+ * pass the structure to COMM_Add. The rest is internal state.
+ */
+typedef struct {
+  uint8_t  port;        ///< HAL port (set by user)
+  uint32_t baud;        ///< Baud rate (set by user)
+  uint8_t* rxBuf;       ///< RX buffer (set by user)
+  uint8_t* txBuf;       ///< TX buffer (set by user)
+  uint16_t bufLen;      ///< Length of each buffer - power of two (set by user)
+  uint8_t  terminator;  ///< Frame terminator character (set by user)
+  uint8_t  binary;      ///< Nonzero - no text drop reports in the stream (set by user)
+  void (*frameCallback)(void* ctx); ///< Called in interrupt on new frames (optional, set by user)
+  void*    frameCtx;    ///< Passed to frameCallback (set by user)
+
+  FIFO_TypeDef rxFifo;                ///< RX FIFO
+  FIFO_TypeDef txFifo;                ///< TX FIFO
+  COMM_FRAMES_TypeDef rxFrames;       ///< Complete frames waiting in RX FIFO
+  COMM_Frame_TypeDef  rxFrame;        ///< Frame being received
+  volatile uint8_t    rxOverrun;      ///< Nonzero if DMA overwrote unread data
+  volatile uint8_t    rxResync;       ///< Nonzero after the reader flushed an overrun
+  uint32_t            txDropped;      ///< Bytes dropped since last overflow report
+} COMM_TypeDef;
+
+void    COMM_Add(COMM_TypeDef* comm);
+void    COMM_PortPutc(COMM_TypeDef* comm, uint8_t c);
+uint16_t COMM_PortWrite(COMM_TypeDef* comm, const uint8_t* data, uint16_t len);
+uint16_t COMM_PortTxFree(COMM_TypeDef* comm);
+uint16_t COMM_PortVprintf(COMM_TypeDef* comm, const char* fmt, va_list args);
+uint16_t COMM_PortPrintf(COMM_TypeDef* comm, const char* fmt, ...)
+    __attribute__((format(printf, 2, 3)));
+uint8_t COMM_PortGetc(COMM_TypeDef* comm);
+uint8_t COMM_PortGetFrame(COMM_TypeDef* comm, uint8_t* buf, uint16_t* len,
+    uint16_t maxLen);
+uint8_t COMM_PortPeekFrame(COMM_TypeDef* comm, COMM_FrameView_TypeDef* view);
+void    COMM_PortReleaseFrame(COMM_TypeDef* comm);
+void    COMM_PortPrintStats(COMM_TypeDef* comm);
+
+// Terminal (console port)
 void    COMM_Init(uint32_t baud);
+void    COMM_SetFrameCallback(void (*callback)(void*), void* ctx);
 void    COMM_Putc(uint8_t c);
+uint16_t COMM_Write(const uint8_t* data, uint16_t len);
+uint16_t COMM_TxFree(void);
+uint16_t COMM_Vprintf(const char* fmt, va_list args);
+uint16_t COMM_Printf(const char* fmt, ...) __attribute__((format(printf, 1, 2)));
 uint8_t COMM_Getc(void);
-uint8_t COMM_GetFrame(uint8_t* buf, uint8_t* len);
+uint8_t COMM_GetFrame(uint8_t* buf, uint16_t* len, uint16_t maxLen);
+uint8_t COMM_PeekFrame(COMM_FrameView_TypeDef* view);
+void    COMM_ReleaseFrame(void);
+void    COMM_PrintStats(void);
 
 /**
  * @}
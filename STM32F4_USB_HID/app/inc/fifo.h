@@ -30,21 +30,75 @@
  * @{
  */
 
+#ifndef FIFO_STATS
+  #define FIFO_STATS 1 ///< Set to 0 to compile out FIFO statistics
+#endif
+
+/**
+ * @brief What to do when data is pushed to a full FIFO.
+ */
+typedef enum {
+  FIFO_POLICY_REJECT,     ///< Drop the new data (default)
+  FIFO_POLICY_OVERWRITE,  ///< Drop the oldest data (producer moves tail!)
+  FIFO_POLICY_BLOCK,      ///< Wait for the consumer up to timeout ms
+} FIFO_Policy_TypeDef;
+
+#if FIFO_STATS
+/**
+ * @brief FIFO statistics.
+ */
+typedef struct {
+  uint16_t peak;    ///< Highest number of stored bytes
+  uint32_t pushes;  ///< Total number of pushed bytes
+  uint32_t pops;    ///< Total number of popped bytes
+  uint32_t drops;   ///< Number of bytes lost due to overflow
+} FIFO_Stats_TypeDef;
+#endif
+
 /**
  * @brief FIFO structure typedef.
+ *
+ * @details The FIFO is a single producer, single consumer ring.
+ * Head is only written by the producer and tail only by the consumer,
+ * so one side may run in an interrupt and the other in the main loop
+ * without disabling interrupts. Both indices run freely and are
+ * wrapped with the mask when accessing the buffer, so the number of
+ * elements is always head - tail.
+ *
+ * The policy and timeout fields are optional (zero means reject new
+ * data on overflow). FIFO_POLICY_OVERWRITE makes the producer move the
+ * tail, so use it only when the consumer can't run at the same time.
+ * FIFO_POLICY_BLOCK only makes sense when the consumer runs in an
+ * interrupt - never use it for a FIFO filled from an interrupt.
  */
 typedef struct {
-  uint16_t head;   ///< Head
-  uint16_t tail;   ///< Tail
-  uint8_t* buf;    ///< Pointer to buffer
-  uint16_t len;    ///< Maximum length of FIFO
-  uint16_t count;  ///< Current number of data elements
+  volatile uint16_t head; ///< Head (write index, modified only by producer)
+  volatile uint16_t tail; ///< Tail (read index, modified only by consumer)
+  uint8_t* buf;           ///< Pointer to buffer
+  uint16_t len;           ///< Maximum length of FIFO (power of two, max 32768)
+  uint16_t mask;          ///< Index mask (len - 1), set by FIFO_Add
+  FIFO_Policy_TypeDef policy; ///< Overflow policy
+  uint32_t timeout;       ///< Timeout in ms for FIFO_POLICY_BLOCK
+#if FIFO_STATS
+  FIFO_Stats_TypeDef stats; ///< Statistics
+#endif
 } FIFO_TypeDef;
 
-uint8_t FIFO_Add      (FIFO_TypeDef* fifo);
-uint8_t FIFO_Push     (FIFO_TypeDef* fifo, uint8_t c);
-uint8_t FIFO_Pop      (FIFO_TypeDef* fifo, uint8_t* c);
-uint8_t FIFO_IsEmpty  (FIFO_TypeDef* fifo);
+uint8_t   FIFO_Add      (FIFO_TypeDef* fifo);
+uint8_t   FIFO_Push     (FIFO_TypeDef* fifo, uint8_t c);
+uint8_t   FIFO_Pop      (FIFO_TypeDef* fifo, uint8_t* c);
+uint8_t   FIFO_IsEmpty  (FIFO_TypeDef* fifo);
+uint16_t  FIFO_Count    (FIFO_TypeDef* fifo);
+uint16_t  FIFO_PushBlock(FIFO_TypeDef* fifo, const uint8_t* data, uint16_t len);
+uint16_t  FIFO_PopBlock (FIFO_TypeDef* fifo, uint8_t* data, uint16_t len);
+uint16_t  FIFO_Peek     (FIFO_TypeDef* fifo, uint8_t** data);
+void      FIFO_Consume  (FIFO_TypeDef* fifo, uint16_t len);
+uint16_t  FIFO_Reserve  (FIFO_TypeDef* fifo, uint16_t maxLen, uint8_t** data);
+void      FIFO_Commit   (FIFO_TypeDef* fifo, uint16_t len);
+#if FIFO_STATS
+void      FIFO_GetStats (FIFO_TypeDef* fifo, FIFO_Stats_TypeDef* stats);
+void      FIFO_ClearStats(FIFO_TypeDef* fifo);
+#endif
 
 /**
  * @}
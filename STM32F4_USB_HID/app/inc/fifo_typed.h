@@ -0,0 +1,116 @@
+/**
+ * @file:   fifo_typed.h
+ * @brief:  Generic fixed element FIFO
+ * @date:   17 paź 2026
+ * @author: Michal Ksiezopolski
+ *
+ * @details A macro generated version of the FIFO for storing
+ * whole elements (HID reports, events...) instead of bytes.
+ * FIFO_TYPED_DEFINE(NAME, type, size) creates the NAME_TypeDef
+ * structure with a buffer for size elements and static inline
+ * NAME_Init, NAME_Push, NAME_Pop, NAME_Front, NAME_IsEmpty and
+ * NAME_Count functions. The size is a compile time constant, so
+ * wrapping is done with a constant mask and there are no runtime
+ * length checks. As with FIFO_TypeDef the FIFO is single
+ * producer, single consumer - one side may run in an interrupt.
+ *
+ * Example:
+ * @code
+ * FIFO_TYPED_DEFINE(REPORTS, HID_Report_TypeDef, 8)
+ * static REPORTS_TypeDef reports;
+ * REPORTS_Push(&reports, &report);
+ * @endcode
+ *
+ * @verbatim
+ * Copyright (c) 2026 Michal Ksiezopolski.
+ * All rights reserved. This program and the
+ * accompanying materials are made available
+ * under the terms of the GNU Public License
+ * v3.0 which accompanies this distribution,
+ * and is available at
+ * http://www.gnu.org/licenses/gpl.html
+ * @endverbatim
+ */
+
+#ifndef FIFO_TYPED_H_
+#define FIFO_TYPED_H_
+
+#include <inttypes.h>
+
+/**
+ * @addtogroup FIFO
+ * @{
+ */
+
+/**
+ * @brief Compiler barrier used between buffer access and index update.
+ */
+#define FIFO_TYPED_BARRIER() __asm volatile ("" : : : "memory")
+
+/**
+ * @brief Defines a FIFO type for elements of given type.
+ * @param NAME Prefix of generated type and functions
+ * @param type Element type
+ * @param size Number of elements (nonzero power of two, max 32768)
+ */
+#define FIFO_TYPED_DEFINE(NAME, type, size)                                   \
+                                                                              \
+typedef char NAME##_SizeCheck[((size) && ((size) & ((size) - 1)) == 0 &&    \
+                               (size) <= 0x8000) ? 1 : -1];                   \
+                                                                              \
+typedef struct {                                                              \
+  volatile uint16_t head; /* Head (modified only by producer) */              \
+  volatile uint16_t tail; /* Tail (modified only by consumer) */              \
+  type buf[size];         /* Elements */                                      \
+} NAME##_TypeDef;                                                             \
+                                                                              \
+static inline void NAME##_Init(NAME##_TypeDef* fifo) {                        \
+  fifo->head = 0;                                                             \
+  fifo->tail = 0;                                                             \
+}                                                                             \
+                                                                              \
+static inline uint16_t NAME##_Count(NAME##_TypeDef* fifo) {                   \
+  return (uint16_t)(fifo->head - fifo->tail);                                 \
+}                                                                             \
+                                                                              \
+static inline uint8_t NAME##_IsEmpty(NAME##_TypeDef* fifo) {                  \
+  return fifo->head == fifo->tail;                                            \
+}                                                                             \
+                                                                              \
+static inline uint8_t NAME##_Push(NAME##_TypeDef* fifo, const type* elem) {   \
+  uint16_t head = fifo->head;                                                 \
+  if ((uint16_t)(head - fifo->tail) == (size)) {                              \
+    return 1; /* full */                                                      \
+  }                                                                           \
+  fifo->buf[head & ((size) - 1)] = *elem;                                     \
+  FIFO_TYPED_BARRIER();                                                       \
+  fifo->head = head + 1;                                                      \
+  return 0;                                                                   \
+}                                                                             \
+                                                                              \
+static inline type* NAME##_Front(NAME##_TypeDef* fifo) {                      \
+  uint16_t tail = fifo->tail;                                                 \
+  if (tail == fifo->head) {                                                   \
+    return (type*)0; /* empty */                                              \
+  }                                                                           \
+  return &fifo->buf[tail & ((size) - 1)];                                     \
+}                                                                             \
+                                                                              \
+static inline uint8_t NAME##_Pop(NAME##_TypeDef* fifo, type* elem) {          \
+  uint16_t tail = fifo->tail;                                                 \
+  if (tail == fifo->head) {                                                   \
+    return 1; /* empty */                                                     \
+  }                                                                           \
+  if (elem) {                                                                 \
+    *elem = fifo->buf[tail & ((size) - 1)];                                   \
+  }                                                                           \
+  FIFO_TYPED_BARRIER();                                                       \
+  fifo->tail = tail + 1;                                                      \
+  return 0;                                                                   \
+}
+
+/**
+ * @}
+ */
+
+#endif /* FIFO_TYPED_H_ */
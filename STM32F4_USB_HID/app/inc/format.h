@@ -0,0 +1,68 @@
+/**
+ * @file    format.h
+ * @brief   Integer only formatted output
+ * @date    17 paź 2026
+ * @author  Michal Ksiezopolski
+ *
+ * @details A small replacement for the printf family. Supported
+ * conversions: %d, %i, %u, %x, %X, %c, %s and %%, with the
+ * '-' (left justify) and '0' (zero pad) flags, a field width
+ * (number or '*') and the 'l' modifier (ignored, int and long
+ * are both 32 bit). There is no floating point, the functions
+ * don't allocate and keep all state in the sink, so they are
+ * reentrant.
+ *
+ * @verbatim
+ * Copyright (c) 2026 Michal Ksiezopolski.
+ * All rights reserved. This program and the
+ * accompanying materials are made available
+ * under the terms of the GNU Public License
+ * v3.0 which accompanies this distribution,
+ * and is available at
+ * http://www.gnu.org/licenses/gpl.html
+ * @endverbatim
+ */
+
+#ifndef FORMAT_H_
+#define FORMAT_H_
+
+#include <inttypes.h>
+#include <stdarg.h>
+
+/**
+ * @defgroup  FORMAT FORMAT
+ * @brief     Integer only formatted output.
+ */
+
+/**
+ * @addtogroup FORMAT
+ * @{
+ */
+
+/**
+ * @brief Output of the formatter.
+ * @details Characters are written straight to buf. When room runs
+ * out refill is called to provide a new buffer (for example the
+ * next contiguous part of a FIFO). Characters that don't fit are
+ * counted in dropped.
+ */
+typedef struct FORMAT_Sink {
+  char*    start;   ///< Start of current buffer
+  char*    buf;     ///< Next character goes here
+  uint16_t room;    ///< Free space left in current buffer
+  uint16_t written; ///< Characters written
+  uint16_t dropped; ///< Characters that didn't fit
+  void*    ctx;     ///< Context of refill
+  uint8_t  (*refill)(struct FORMAT_Sink* sink); ///< Get new buffer (0 - success), may be NULL
+} FORMAT_Sink_TypeDef;
+
+uint16_t FORMAT_Vprint(FORMAT_Sink_TypeDef* sink, const char* fmt, va_list args);
+uint16_t FORMAT_Vsnprintf(char* buf, uint16_t size, const char* fmt, va_list args);
+uint16_t FORMAT_Snprintf(char* buf, uint16_t size, const char* fmt, ...)
+    __attribute__((format(printf, 3, 4)));
+
+/**
+ * @}
+ */
+
+#endif /* FORMAT_H_ */
@@ -29,6 +29,8 @@
  * @addtogroup KEYS
  * @{
  */
+#define KEYS_SCAN_TIME 2 ///< Period of KEYS_Update calls in ms (one column per call)
+
 typedef enum {
   KEY0 = 0x31,
   KEY1 = 0x00,
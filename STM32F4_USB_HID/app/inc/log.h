@@ -0,0 +1,174 @@
+/**
+ * @file    log.h
+ * @brief   Logging with per module levels
+ * @date    17 paź 2026
+ * @author  Michal Ksiezopolski
+ *
+ * @details Every module has its own level, which can be changed at
+ * runtime with the :LOG command. A disabled log statement costs one
+ * compare and its arguments are not evaluated. Statements above
+ * LOG_MAX_LEVEL are removed at compile time.
+ *
+ * Messages are formatted once and passed to every sink (UART,
+ * ITM, RAM ring or one added with LOG_AddSink) whose filter lets
+ * them through. Sinks never block - a message a sink can't take
+ * right away is dropped and counted for that sink only.
+ *
+ * Define LOG_MODULE before including this file to use the short macros:
+ * @code
+ * #define LOG_MODULE LOG_COMM
+ * #include <log.h>
+ * LOG_ERR("Frame too long");
+ * LOG_LIMITED(LOG_WARN, 1000, "RX overrun"); // at most once a second
+ * @endcode
+ *
+ * @verbatim
+ * Copyright (c) 2026 Michal Ksiezopolski.
+ * All rights reserved. This program and the
+ * accompanying materials are made available
+ * under the terms of the GNU Public License
+ * v3.0 which accompanies this distribution,
+ * and is available at
+ * http://www.gnu.org/licenses/gpl.html
+ * @endverbatim
+ */
+
+#ifndef LOG_H_
+#define LOG_H_
+
+#include <inttypes.h>
+
+/**
+ * @defgroup  LOG LOG
+ * @brief     Logging with per module levels.
+ */
+
+/**
+ * @addtogroup LOG
+ * @{
+ */
+
+/**
+ * @brief Log levels.
+ */
+typedef enum {
+  LOG_OFF,    ///< Nothing is logged
+  LOG_ERROR,  ///< Errors
+  LOG_WARN,   ///< Warnings
+  LOG_INFO,   ///< Information
+  LOG_DEBUG,  ///< Debugging messages
+} LOG_Level_TypeDef;
+
+/**
+ * @brief Modules with a separate log level.
+ */
+typedef enum {
+  LOG_MAIN,
+  LOG_FIFO,
+  LOG_COMM,
+  LOG_LED,
+  LOG_KEYS,
+  LOG_TIMER,
+  LOG_USB,
+  LOG_CMD,
+  LOG_PROTO,
+  LOG_SCHED,
+  LOG_MODULE_COUNT,
+} LOG_Module_TypeDef;
+
+#ifndef LOG_MAX_LEVEL
+  #define LOG_MAX_LEVEL LOG_DEBUG ///< Statements above this level are compiled out
+#endif
+
+#ifndef LOG_LINE_LEN
+  #define LOG_LINE_LEN 128 ///< Longest message (longer ones are cut)
+#endif
+
+#ifndef LOG_MAX_SINKS
+  #define LOG_MAX_SINKS 4 ///< Maximum number of sinks
+#endif
+
+#ifndef LOG_DEFAULT_LEVEL
+  #define LOG_DEFAULT_LEVEL LOG_INFO ///< Level of all modules after startup
+#endif
+
+/**
+ * @brief Limits a log statement to one message per interval.
+ */
+typedef struct {
+  uint64_t next;        ///< Deadline of next allowed message
+  uint16_t suppressed;  ///< Messages suppressed since last one
+} LOG_Limit_TypeDef;
+
+/**
+ * @brief Output of log messages.
+ */
+typedef struct {
+  const char* name;   ///< Sink name (for :LOG command)
+  uint8_t  level;     ///< Highest level passed to sink
+  uint32_t modules;   ///< Bit mask of modules passed to sink
+  /**
+   * @brief Writes a message without blocking.
+   * @details May be called from interrupts.
+   * @return Number of bytes taken (message is dropped if less than len)
+   */
+  uint16_t (*write)(const uint8_t* data, uint16_t len);
+  uint32_t drops;     ///< Messages dropped by sink
+} LOG_Sink_TypeDef;
+
+#define LOG_ALL_MODULES ((1UL << LOG_MODULE_COUNT) - 1) ///< Sink module mask passing everything
+
+extern uint8_t logLevels[LOG_MODULE_COUNT]; ///< Current levels (use LOG_SetLevel)
+
+/**
+ * @brief Checks if a level is enabled for a module.
+ */
+#define LOG_ENABLED(module, level) \
+  ((level) <= LOG_MAX_LEVEL && (level) <= logLevels[module])
+
+/**
+ * @brief Log a message.
+ * @param module Module
+ * @param level Level of message
+ * @param fmt Format string literal (see format.h)
+ */
+#define LOG(module, level, fmt, args...) do {               \
+  if (LOG_ENABLED(module, level)) {                         \
+    LOG_Print(module, level, fmt, ##args);                  \
+  }                                                         \
+} while (0)
+
+/**
+ * @brief Log a message at most once per interval.
+ * @details Every call site has its own limit. The number of
+ * suppressed messages is printed with the next one.
+ * @param level Level of message
+ * @param ms Interval in ms
+ * @param fmt Format string literal (see format.h)
+ */
+#define LOG_LIMITED(level, ms, fmt, args...) do {           \
+  static LOG_Limit_TypeDef logLimit;                        \
+  if (LOG_ENABLED(LOG_MODULE, level) &&                     \
+      LOG_Allow(LOG_MODULE, level, &logLimit, ms)) {        \
+    LOG_Print(LOG_MODULE, level, fmt, ##args);              \
+  }                                                         \
+} while (0)
+
+#define LOG_ERR(fmt, args...) LOG(LOG_MODULE, LOG_ERROR, fmt, ##args) ///< Log error
+#define LOG_WRN(fmt, args...) LOG(LOG_MODULE, LOG_WARN, fmt, ##args)  ///< Log warning
+#define LOG_INF(fmt, args...) LOG(LOG_MODULE, LOG_INFO, fmt, ##args)  ///< Log information
+#define LOG_DBG(fmt, args...) LOG(LOG_MODULE, LOG_DEBUG, fmt, ##args) ///< Log debugging message
+
+void    LOG_Init      (void);
+void    LOG_SetLevel  (LOG_Module_TypeDef module, LOG_Level_TypeDef level);
+uint8_t LOG_AddSink   (LOG_Sink_TypeDef* sink);
+uint8_t LOG_Allow     (LOG_Module_TypeDef module, LOG_Level_TypeDef level,
+    LOG_Limit_TypeDef* limit, uint32_t ms);
+void    LOG_Print     (LOG_Module_TypeDef module, LOG_Level_TypeDef level,
+    const char* fmt, ...) __attribute__((format(printf, 3, 4)));
+
+/**
+ * @}
+ */
+
+#endif /* LOG_H_ */
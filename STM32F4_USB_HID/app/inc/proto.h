@@ -0,0 +1,95 @@
+/**
+ * @file    proto.h
+ * @brief   Binary command protocol
+ * @date    17 paź 2026
+ * @author  Michal Ksiezopolski
+ *
+ * @details Packets are COBS encoded and terminated with a zero byte,
+ * so a lost byte costs at most one packet and the receiver resyncs on
+ * the next zero. Decoded packet (multibyte fields little endian):
+ *
+ * | Field   | Size | Description                                  |
+ * |---------|------|----------------------------------------------|
+ * | opcode  | 1    | Request opcode (replies have PROTO_REPLY set)|
+ * | seq     | 1    | Sequence number, copied to the reply         |
+ * | len     | 2    | Payload length (max PROTO_MAX_PAYLOAD)       |
+ * | payload | len  | Opcode specific data                         |
+ * | crc     | 4    | CRC32 of the fields above (see CRC_HAL_Calc) |
+ *
+ * Requests are queued by COMM, so the host can send several of
+ * them without waiting and match the replies using seq. Packets
+ * with a bad CRC or length are dropped without a reply.
+ *
+ * @verbatim
+ * Copyright (c) 2026 Michal Ksiezopolski.
+ * All rights reserved. This program and the
+ * accompanying materials are made available
+ * under the terms of the GNU Public License
+ * v3.0 which accompanies this distribution,
+ * and is available at
+ * http://www.gnu.org/licenses/gpl.html
+ * @endverbatim
+ */
+
+#ifndef PROTO_H_
+#define PROTO_H_
+
+#include <inttypes.h>
+
+/**
+ * @defgroup  PROTO PROTO
+ * @brief     Binary command protocol.
+ */
+
+/**
+ * @addtogroup PROTO
+ * @{
+ */
+
+#define PROTO_HEADER_LEN   4    ///< Opcode, seq and length
+#define PROTO_CRC_LEN      4    ///< CRC32
+#define PROTO_MAX_PAYLOAD  240  ///< Maximum payload length
+#define PROTO_REPLY        0x80 ///< Opcode flag of replies
+
+/**
+ * @brief Request opcodes.
+ */
+typedef enum {
+  PROTO_OP_PING   = 0x01, ///< Echo payload back
+  PROTO_OP_LED    = 0x02, ///< Set LED (payload: LED number, state)
+  PROTO_OP_STATS  = 0x03, ///< Get PROTO_Stats_TypeDef
+} PROTO_Op_TypeDef;
+
+/**
+ * @brief Status sent as a one byte reply payload on errors.
+ */
+typedef enum {
+  PROTO_OK          = 0,  ///< Request handled (handler replied)
+  PROTO_ERR_OPCODE  = 1,  ///< Unknown opcode
+  PROTO_ERR_ARGS    = 2,  ///< Invalid payload
+} PROTO_Status_TypeDef;
+
+/**
+ * @brief Protocol statistics.
+ */
+typedef struct {
+  uint32_t rxPackets;   ///< Valid packets received
+  uint32_t txPackets;   ///< Packets sent
+  uint32_t crcErrors;   ///< Packets dropped because of bad CRC
+  uint32_t frameErrors; ///< Packets dropped because of bad encoding or length
+  uint32_t txDropped;   ///< Packets not sent because TX FIFO was full
+} PROTO_Stats_TypeDef;
+
+void    PROTO_Init(uint8_t port, uint32_t baud,
+    uint8_t (*handler)(uint8_t op, uint8_t seq, const uint8_t* data, uint16_t len));
+void    PROTO_SetFrameCallback(void (*callback)(void*), void* ctx);
+void    PROTO_Update(void);
+uint8_t PROTO_Send(uint8_t op, uint8_t seq, const uint8_t* data, uint16_t len);
+uint8_t PROTO_Reply(uint8_t op, uint8_t seq, const uint8_t* data, uint16_t len);
+void    PROTO_GetStats(PROTO_Stats_TypeDef* stats);
+
+/**
+ * @}
+ */
+
+#endif /* PROTO_H_ */
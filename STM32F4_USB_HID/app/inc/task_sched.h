@@ -0,0 +1,86 @@
+/**
+ * @file    task_sched.h
+ * @brief   Cooperative task scheduler with priorities
+ * @date    17 paź 2026
+ * @author  Michal Ksiezopolski
+ *
+ * @details Tasks are functions which run to completion. A task runs
+ * when it has pending events - bits posted with SCHED_Post from the
+ * main loop or from interrupts. Before every task the scheduler picks
+ * the ready task with the highest priority (lowest number), so a slow
+ * console command delays the HID task by at most one run of the
+ * command. Tasks with equal priority run in the order they were added.
+ * Soft timers are updated between tasks - their callbacks should only
+ * post events (see SCHED_Notify).
+ *
+ * Example:
+ * @code
+ * static void hidTask(void* ctx, uint32_t events) { ... }
+ * int8_t id = SCHED_AddTask("HID", 0, hidTask, NULL);
+ * int16_t timer = TIMER_AddSoftTimer(20, TIMER_PERIODIC, SCHED_Notify,
+ *     SCHED_NOTIFY_CTX(id));
+ * TIMER_StartSoftTimer(timer);
+ * SCHED_Run();
+ * @endcode
+ *
+ * @verbatim
+ * Copyright (c) 2026 Michal Ksiezopolski.
+ * All rights reserved. This program and the
+ * accompanying materials are made available
+ * under the terms of the GNU Public License
+ * v3.0 which accompanies this distribution,
+ * and is available at
+ * http://www.gnu.org/licenses/gpl.html
+ * @endverbatim
+ */
+
+#ifndef SCHED_H_
+#define SCHED_H_
+
+#include <inttypes.h>
+
+/**
+ * @defgroup  SCHED SCHED
+ * @brief     Cooperative task scheduler.
+ */
+
+/**
+ * @addtogroup SCHED
+ * @{
+ */
+
+#ifndef SCHED_MAX_TASKS
+  #define SCHED_MAX_TASKS 8 ///< Maximum number of tasks
+#endif
+
+#define SCHED_EVENT_NOTIFY 0x80000000 ///< Event posted by SCHED_Notify
+
+/**
+ * @brief Makes the SCHED_Notify context of a task.
+ * @param id Task ID
+ */
+#define SCHED_NOTIFY_CTX(id) ((void*)(uintptr_t)(id))
+
+/**
+ * @brief Task statistics.
+ */
+typedef struct {
+  uint32_t runs;        ///< Number of runs
+  uint32_t maxCycles;   ///< Longest run (TIMER_GetCycles ticks)
+  uint64_t totalCycles; ///< Time of all runs (TIMER_GetCycles ticks)
+} SCHED_Stats_TypeDef;
+
+void    SCHED_Init    (void);
+int8_t  SCHED_AddTask (const char* name, uint8_t priority,
+    void (*fun)(void*, uint32_t), void* ctx);
+void    SCHED_Post    (uint8_t id, uint32_t events);
+void    SCHED_Notify  (void* ctx);
+void    SCHED_Poll    (void);
+void    SCHED_Run     (void) __attribute__((noreturn));
+void    SCHED_GetStats(uint8_t id, SCHED_Stats_TypeDef* stats);
+
+/**
+ * @}
+ */
+
+#endif /* SCHED_H_ */
@@ -33,14 +33,33 @@
  * @{
  */
 
+/**
+ * @brief Soft timer modes.
+ */
+typedef enum {
+  TIMER_PERIODIC, ///< Restarts on overflow (without drift)
+  TIMER_ONE_SHOT, ///< Stops on overflow
+} TIMER_Mode_TypeDef;
+
 void      TIMER_Init              (uint32_t freq);
 void      TIMER_DelayUS           (uint32_t us);
 void      TIMER_Delay             (uint32_t ms);
-uint8_t   TIMER_DelayTimer        (uint32_t ms, uint32_t startTime);
-int8_t    TIMER_AddSoftTimer      (uint32_t maxVal, void (*fun)(void));
-void      TIMER_StartSoftTimer    (uint8_t id);
+int16_t   TIMER_AddSoftTimer      (uint32_t maxVal, TIMER_Mode_TypeDef mode,
+    void (*fun)(void*), void* ctx);
+void      TIMER_DeleteSoftTimer   (uint16_t id);
+void      TIMER_StartSoftTimer    (uint16_t id);
+void      TIMER_StopSoftTimer     (uint16_t id);
+void      TIMER_PauseSoftTimer    (uint16_t id);
+void      TIMER_ResumeSoftTimer   (uint16_t id);
 void      TIMER_SoftTimersUpdate  (void);
+void      TIMER_Idle              (void);
 uint32_t  TIMER_GetTime           (void);
+uint64_t  TIMER_Now64             (void);
+uint64_t  TIMER_DeadlineAfter     (uint32_t ms);
+uint8_t   TIMER_DeadlineExpired   (uint64_t deadline);
+uint32_t  TIMER_GetCycles         (void);
+uint32_t  TIMER_GetCyclesFreq     (void);
+uint32_t  TIMER_CyclesToNs        (uint32_t cycles);
 
 /**
  * @}
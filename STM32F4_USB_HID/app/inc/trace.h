@@ -0,0 +1,99 @@
+/**
+ * @file    trace.h
+ * @brief   Deferred binary trace
+ * @date    17 paź 2026
+ * @author  Michal Ksiezopolski
+ *
+ * @details TRACE works like LOG_INF, but with TRACE_BINARY set the
+ * text is never formatted on the MCU. The format string is placed in
+ * the .trace_fmt section, which is kept in the ELF file but not
+ * loaded into flash. Its address in that section is the ID of the
+ * message. Each call stores a short record in a RAM ring (safe from
+ * interrupts) and TRACE_Update sends the records to the terminal
+ * from the main loop. tools/trace_decode.py turns them back into text
+ * using the ELF file. Other terminal output passes through it unchanged.
+ *
+ * Record (little endian):
+ *
+ * | Field     | Size  | Description                        |
+ * |-----------|-------|------------------------------------|
+ * | sync      | 1     | TRACE_SYNC + number of arguments   |
+ * | id        | 2     | Offset of format in .trace_fmt     |
+ * | timestamp | 4     | TIMER_GetTime (ms)                 |
+ * | args      | 4 * n | Arguments                          |
+ *
+ * Arguments have to be integers (%d, %u, %x, %c), at most
+ * TRACE_MAX_ARGS of them. Format strings must be literals.
+ *
+ * @verbatim
+ * Copyright (c) 2026 Michal Ksiezopolski.
+ * All rights reserved. This program and the
+ * accompanying materials are made available
+ * under the terms of the GNU Public License
+ * v3.0 which accompanies this distribution,
+ * and is available at
+ * http://www.gnu.org/licenses/gpl.html
+ * @endverbatim
+ */
+
+#ifndef TRACE_H_
+#define TRACE_H_
+
+#include <inttypes.h>
+
+/**
+ * @defgroup  TRACE TRACE
+ * @brief     Deferred binary trace.
+ */
+
+/**
+ * @addtogroup TRACE
+ * @{
+ */
+
+#ifndef TRACE_BINARY
+  #define TRACE_BINARY 1 ///< Send binary records (0 - format text right away)
+#endif
+
+#define TRACE_MAX_ARGS  4     ///< Maximum number of arguments
+#define TRACE_SYNC      0xF0  ///< Record start (never appears in ASCII text)
+
+/**
+ * @brief Counts the arguments of TRACE (0 to 4).
+ */
+#define TRACE_NARGS(args...) TRACE_NARGS_(0, ##args, 4, 3, 2, 1, 0)
+#define TRACE_NARGS_(_0, _1, _2, _3, _4, n, ...) n
+
+#if TRACE_BINARY
+
+/**
+ * @brief Trace a message.
+ * @param fmt Format string literal
+ */
+#define TRACE(fmt, args...) do {                                        \
+  static const char traceFmt[]                                          \
+    __attribute__((section(".trace_fmt"), used)) = fmt;                 \
+  (void)sizeof(char[TRACE_NARGS(args) <= TRACE_MAX_ARGS ? 1 : -1]);    \
+  TRACE_Record((uint16_t)(uint32_t)traceFmt, TRACE_NARGS(args), ##args);\
+} while (0)
+
+#else
+
+/**
+ * @brief Trace a message (printed right away, dropped in interrupts).
+ * @param fmt Format string literal
+ */
+#define TRACE(fmt, args...) TRACE_Print(fmt "\r\n", ##args)
+
+#endif
+
+void  TRACE_Init    (void);
+void  TRACE_Record  (uint16_t id, uint8_t argc, ...);
+void  TRACE_Print   (const char* fmt, ...) __attribute__((format(printf, 1, 2)));
+void  TRACE_Update  (void);
+
+/**
+ * @}
+ */
+
+#endif /* TRACE_H_ */
@@ -16,13 +16,19 @@
  * @endverbatim
  */
 
-#include <stdio.h>
 #include <string.h>
 
 #include <timers.h>
 #include <led.h>
 #include <comm.h>
 #include <keys.h>
+#include <proto.h>
+#include <cmd.h>
+#include <trace.h>
+#include <log.h>
+#include <task_sched.h>
+// HAL
+#include <uart.h>
 
 // USB includes
 #include <usbd_usr.h>
@@ -32,23 +38,26 @@
 
 #define SYSTICK_FREQ 1000 ///< Frequency of the SysTick set at 1kHz.
 #define COMM_BAUD_RATE 115200UL ///< Baud rate for communication with PC
-
-void softTimerCallback(void);
-void usbSoftTimerCallback(void);
-
-#define DEBUG
-
-#ifdef DEBUG
-#define print(str, args...) printf(""str"%s",##args,"")
-#define println(str, args...) printf("MAIN--> "str"%s",##args,"\r\n")
-#else
-#define print(str, args...) (void)0
-#define println(str, args...) (void)0
-#endif
+#define PROTO_BAUD_RATE 921600UL ///< Baud rate of binary protocol link
+#define PROTO_PORT UART_PORT6 ///< Port of binary protocol link
+#define BACKGROUND_TIME 10 ///< Period of background task in ms
+
+void softTimerCallback(void* ctx);
+void hidTask(void* ctx, uint32_t events);
+void keysTask(void* ctx, uint32_t events);
+void protoTask(void* ctx, uint32_t events);
+void consoleTask(void* ctx, uint32_t events);
+void backgroundTask(void* ctx, uint32_t events);
+void ledCommand(uint8_t argc, const CMD_Token_TypeDef* argv);
+void statsCommand(uint8_t argc, const CMD_Token_TypeDef* argv);
+uint8_t protoHandler(uint8_t op, uint8_t seq, const uint8_t* data, uint16_t len);
+
+#define LOG_MODULE LOG_MAIN ///< Module of log messages
 
 __ALIGN_BEGIN USB_OTG_CORE_HANDLE USB_OTG_dev __ALIGN_END; ///< USB device handle
 
 static uint8_t key;
+static int8_t consoleTaskID; ///< Task handling terminal commands
 
 /**
  * @brief Main function
@@ -57,15 +66,23 @@ static uint8_t key;
 int main(void) {
 
   COMM_Init(COMM_BAUD_RATE); // initialize communication with PC
-  println("Starting program"); // Print a string to terminal
+  LOG_INF("Starting program"); // Print a string to terminal
+
+  TRACE_Init(); // binary trace records go to terminal
+  LOG_Init();   // :LOG command
 
   TIMER_Init(SYSTICK_FREQ); // Initialize timer
+  SCHED_Init(); // :TASKS command
 
   // Add a soft timer with callback running every 1000ms
-  int8_t timerID = TIMER_AddSoftTimer(1000, softTimerCallback);
+  int16_t timerID = TIMER_AddSoftTimer(1000, TIMER_PERIODIC,
+      softTimerCallback, NULL);
   TIMER_StartSoftTimer(timerID); // start the timer
 
-  int8_t usbTimerID = TIMER_AddSoftTimer(20, usbSoftTimerCallback);
+  // HID reports are time critical - highest priority
+  int8_t hidTaskID = SCHED_AddTask("HID", 0, hidTask, &USB_OTG_dev);
+  int16_t usbTimerID = TIMER_AddSoftTimer(20, TIMER_PERIODIC,
+      SCHED_Notify, SCHED_NOTIFY_CTX(hidTaskID));
   TIMER_StartSoftTimer(usbTimerID);
 
   LED_Init(LED0); // Add an LED
@@ -77,11 +94,32 @@ int main(void) {
 
   KEYS_Init(); // Initialize matrix keyboard
 
-  uint8_t buf[255]; // buffer for receiving commands from PC
-  uint8_t len;      // length of command
+  int8_t keysTaskID = SCHED_AddTask("KEYS", 1, keysTask, NULL);
+  int16_t keysTimerID = TIMER_AddSoftTimer(KEYS_SCAN_TIME, TIMER_PERIODIC,
+      SCHED_Notify, SCHED_NOTIFY_CTX(keysTaskID));
+  TIMER_StartSoftTimer(keysTimerID); // scan keyboard
 
-  // test another way of measuring time delays
-  uint32_t softTimer = TIMER_GetTime(); // get start time for delay
+  CMD_Register(":LED0", ledCommand, 1, 1);    // control LED0 from terminal
+  CMD_Register(":STATS", statsCommand, 0, 0); // print COMM buffer statistics
+
+  PROTO_Init(PROTO_PORT, PROTO_BAUD_RATE, protoHandler); // binary protocol link
+
+  // tasks for received frames, first run handles frames received so far
+  int8_t protoTaskID = SCHED_AddTask("PROTO", 2, protoTask, NULL);
+  PROTO_SetFrameCallback(SCHED_Notify, SCHED_NOTIFY_CTX(protoTaskID));
+  SCHED_Post(protoTaskID, SCHED_EVENT_NOTIFY);
+
+  consoleTaskID = SCHED_AddTask("CONSOLE", 3, consoleTask, NULL);
+  COMM_SetFrameCallback(SCHED_Notify, SCHED_NOTIFY_CTX(consoleTaskID));
+  SCHED_Post(consoleTaskID, SCHED_EVENT_NOTIFY);
+
+  int8_t backgroundTaskID = SCHED_AddTask("BACKGND", 4, backgroundTask, NULL);
+  int16_t backgroundTimerID = TIMER_AddSoftTimer(BACKGROUND_TIME,
+      TIMER_PERIODIC, SCHED_Notify, SCHED_NOTIFY_CTX(backgroundTaskID));
+  TIMER_StartSoftTimer(backgroundTimerID);
+
+  // keep running tasks during long USB initialization delays
+  USB_OTG_BSP_SetIdleHook(SCHED_Poll);
 
   // Initialize USB device stack
   USBD_Init(&USB_OTG_dev,
@@ -90,31 +128,121 @@ int main(void) {
             &USBD_HID_cb, // class callbacks
             &USR_cb); // user callbacks
 
-  while (1) {
+  SCHED_Run(); // never returns
+}
 
-    // test delay method
-    if (TIMER_DelayTimer(1000, softTimer)) {
-      LED_Toggle(LED3);
-      softTimer = TIMER_GetTime(); // get start time for delay
-    }
+/**
+ * @brief Handles commands from the terminal.
+ * @details Handles one frame per run, so higher priority tasks don't
+ * wait for the whole backlog.
+ * @param ctx Unused
+ * @param events Events
+ */
+void consoleTask(void* ctx, uint32_t events) {
+
+  uint8_t buf[255]; // buffer for receiving commands from PC
+  uint16_t len;     // length of command
+  COMM_FrameView_TypeDef view;
+
+  // check for new frames from PC
+  if (!COMM_GetFrame(buf, &len, sizeof(buf))) {
+    TRACE("Got frame of length %d", (int)len);
+    CMD_Dispatch((char*)buf, len);
+  }
+
+  if (COMM_PeekFrame(&view) != 1) { // more frames waiting (or an invalid one dropped)
+    SCHED_Post(consoleTaskID, SCHED_EVENT_NOTIFY);
+  }
+}
+/**
+ * @brief Handles binary protocol requests.
+ * @param ctx Unused
+ * @param events Events
+ */
+void protoTask(void* ctx, uint32_t events) {
+  PROTO_Update(); // handle binary requests
+}
+/**
+ * @brief Runs work without deadlines.
+ * @param ctx Unused
+ * @param events Events
+ */
+void backgroundTask(void* ctx, uint32_t events) {
+
+  // test another way of measuring time delays
+  static uint64_t ledDeadline; // end of delay
 
-    // check for new frames from PC
-    if (!COMM_GetFrame(buf, &len)) {
-      println("Got frame of length %d: %s", (int)len, (char*)buf);
-
-      // control LED0 from terminal
-      if (!strcmp((char*)buf, ":LED0 ON")) {
-        LED_ChangeState(LED0, LED_ON);
-      }
-      if (!strcmp((char*)buf, ":LED0 OFF")) {
-        LED_ChangeState(LED0, LED_OFF);
-      }
+  // test delay method
+  if (TIMER_DeadlineExpired(ledDeadline)) {
+    LED_Toggle(LED3);
+    ledDeadline = TIMER_DeadlineAfter(1000); // start next delay
+  }
+
+  TRACE_Update(); // send trace records
+}
+
+/**
+ * @brief Handles :LED0 ON and :LED0 OFF commands
+ * @param argc Number of arguments
+ * @param argv Arguments
+ */
+void ledCommand(uint8_t argc, const CMD_Token_TypeDef* argv) {
+
+  if (CMD_TokenEquals(&argv[0], "ON")) {
+    LED_ChangeState(LED0, LED_ON);
+  } else if (CMD_TokenEquals(&argv[0], "OFF")) {
+    LED_ChangeState(LED0, LED_OFF);
+  } else {
+    LOG_WRN("Usage: :LED0 ON|OFF");
+  }
+}
+
+/**
+ * @brief Handles :STATS command
+ * @param argc Number of arguments
+ * @param argv Arguments
+ */
+void statsCommand(uint8_t argc, const CMD_Token_TypeDef* argv) {
+  COMM_PrintStats();
+}
+
+/**
+ * @brief Handles binary protocol requests
+ * @param op Opcode
+ * @param seq Sequence number
+ * @param data Payload
+ * @param len Length of payload
+ * @return Status (PROTO_OK if reply was sent)
+ */
+uint8_t protoHandler(uint8_t op, uint8_t seq, const uint8_t* data, uint16_t len) {
+
+  PROTO_Stats_TypeDef stats;
+  uint8_t status = PROTO_OK;
+
+  switch (op) {
+
+  case PROTO_OP_PING:
+    PROTO_Reply(op, seq, data, len);
+    break;
+
+  case PROTO_OP_LED:
+    if (len != 2 || data[0] > LED9 || data[1] > LED_ON) {
+      return PROTO_ERR_ARGS;
     }
+    LED_ChangeState(data[0], data[1]);
+    PROTO_Reply(op, seq, &status, 1);
+    break;
 
-    TIMER_SoftTimersUpdate(); // run timers
-    key = KEYS_Update(); // run keyboard
+  case PROTO_OP_STATS: // structure sent as is (little endian)
+    PROTO_GetStats(&stats);
+    PROTO_Reply(op, seq, (uint8_t*)&stats, sizeof(stats));
+    break;
 
+  default:
+    return PROTO_ERR_OPCODE;
   }
+
+  return PROTO_OK;
 }
 
 #define HID_STEP 10 ///< Cursor step for every move
@@ -127,7 +255,7 @@ void getHIDPosition(uint8_t* buf) {
 
   int8_t x = 0, y = 0;
   uint8_t buttons = 0;
-  static uint32_t buttonTimer;
+  static uint64_t buttonDeadline;
   static uint8_t debounce;
 
   switch(key) {
@@ -174,10 +302,10 @@ void getHIDPosition(uint8_t* buf) {
 
   case KEY_ASTERISK:
 //    if (!debounce) {
-//      buttonTimer = TIMER_GetTime();
+//      buttonDeadline = TIMER_DeadlineAfter(200);
 //      debounce = 1;
       buttons |= 0x04; // left mouse button
-//    } else if (TIMER_DelayTimer(200, buttonTimer)) {
+//    } else if (TIMER_DeadlineExpired(buttonDeadline)) {
 //      debounce = 0;
 //    }
       x = HID_STEP;
@@ -204,24 +332,37 @@ void getHIDPosition(uint8_t* buf) {
 }
 
 /**
- * @brief Callback for periodic handling of
+ * @brief Task for periodic handling of
  * USB stuff.
+ * @param ctx USB device handle
+ * @param events Events
  */
-void usbSoftTimerCallback(void) {
+void hidTask(void* ctx, uint32_t events) {
 
+  USB_OTG_CORE_HANDLE* dev = ctx;
   uint8_t buf[4];
 
   getHIDPosition(buf);
 
   if((buf[1] != 0) ||(buf[2] != 0)) {
-    USBD_HID_SendReport (&USB_OTG_dev, buf, 4);
+    USBD_HID_SendReport (dev, buf, 4);
   }
 }
 
+/**
+ * @brief Task scanning the keyboard.
+ * @param ctx Unused
+ * @param events Events
+ */
+void keysTask(void* ctx, uint32_t events) {
+  key = KEYS_Update(); // run keyboard
+}
+
 /**
  * @brief Callback function called on every soft timer overflow
+ * @param ctx Unused
  */
-void softTimerCallback(void) {
+void softTimerCallback(void* ctx) {
 
   static uint8_t counter;
 
@@ -244,6 +385,6 @@ void softTimerCallback(void) {
 
   }
 
-  println("Test string sent from STM32F4!!!"); // Print test string
+  LOG_DBG("Test string sent from STM32F4!!!"); // Print test string
   counter++;
 }
@@ -15,7 +15,7 @@
  * @endverbatim
  */
 
-#include <stdio.h>
+#include <comm.h>
 #include <inttypes.h>
 
 /**
@@ -28,6 +28,6 @@
  * @param line Line number where error occurred
  */
 void assert_failed(uint8_t* file, uint32_t line) {
-      printf("Assert fail at File %s Line %d\n", file, (int)line);
+      COMM_Printf("Assert fail at File %s Line %d\n", file, (int)line);
       while(1); // hold program
 }
@@ -0,0 +1,200 @@
+/**
+ * @file    cmd.c
+ * @brief   Terminal command dispatcher
+ * @date    17 paź 2026
+ * @author  Michal Ksiezopolski
+ *
+ * @verbatim
+ * Copyright (c) 2026 Michal Ksiezopolski.
+ * All rights reserved. This program and the
+ * accompanying materials are made available
+ * under the terms of the GNU Public License
+ * v3.0 which accompanies this distribution,
+ * and is available at
+ * http://www.gnu.org/licenses/gpl.html
+ * @endverbatim
+ */
+
+#include <cmd.h>
+#include <log.h>
+#include <string.h>
+
+#define LOG_MODULE LOG_CMD ///< Module of log messages
+
+typedef char CMD_CountCheck[CMD_MAX_COMMANDS <= 255 ? 1 : -1]; // uint8_t indices
+
+/**
+ * @addtogroup CMD
+ * @{
+ */
+
+/**
+ * @brief Registered command.
+ */
+typedef struct {
+  const char* name;     ///< Command name
+  uint16_t    nameLen;  ///< Length of name
+  uint8_t     minArgs;  ///< Minimum number of arguments
+  uint8_t     maxArgs;  ///< Maximum number of arguments
+  void (*handler)(uint8_t argc, const CMD_Token_TypeDef* argv); ///< Handler
+} CMD_Command_TypeDef;
+
+static CMD_Command_TypeDef commands[CMD_MAX_COMMANDS]; ///< Commands sorted by name
+static uint8_t commandCount; ///< Number of registered commands
+
+/**
+ * @brief Compares a token with a command name.
+ * @param str Token
+ * @param len Length of token
+ * @param cmd Command
+ * @return Negative, zero or positive like strcmp
+ */
+static int CMD_Compare(const char* str, uint16_t len, const CMD_Command_TypeDef* cmd) {
+
+  uint16_t n = len < cmd->nameLen ? len : cmd->nameLen;
+  int ret = memcmp(str, cmd->name, n);
+
+  if (ret) {
+    return ret;
+  }
+  return (int)len - (int)cmd->nameLen;
+}
+/**
+ * @brief Register a command.
+ * @details Commands are registered at startup, so keeping the
+ * table sorted on insertion costs nothing at dispatch time.
+ * @param name Command name (not copied - must stay valid)
+ * @param handler Handler getting the arguments (without the name)
+ * @param minArgs Minimum number of arguments
+ * @param maxArgs Maximum number of arguments (max CMD_MAX_ARGS)
+ * @retval 0 Command registered
+ * @retval 1 Table full, name already registered or invalid arguments
+ */
+uint8_t CMD_Register(const char* name,
+    void (*handler)(uint8_t argc, const CMD_Token_TypeDef* argv),
+    uint8_t minArgs, uint8_t maxArgs) {
+
+  uint16_t len = strlen(name);
+  uint8_t i;
+  int ret;
+
+  if (commandCount >= CMD_MAX_COMMANDS || maxArgs > CMD_MAX_ARGS ||
+      minArgs > maxArgs || len == 0) {
+    LOG_ERR("Can't register %s", name);
+    return 1;
+  }
+
+  // find insertion point
+  for (i = commandCount; i > 0; i--) {
+    ret = CMD_Compare(name, len, &commands[i - 1]);
+    if (ret == 0) {
+      LOG_ERR("%s already registered", name);
+      return 1;
+    }
+    if (ret > 0) {
+      break;
+    }
+  }
+
+  // make room for the new command
+  memmove(&commands[i + 1], &commands[i], (commandCount - i) * sizeof(commands[0]));
+
+  commands[i].name    = name;
+  commands[i].nameLen = len;
+  commands[i].minArgs = minArgs;
+  commands[i].maxArgs = maxArgs;
+  commands[i].handler = handler;
+  commandCount++;
+
+  return 0;
+}
+/**
+ * @brief Dispatch a frame to the handler of its command.
+ * @details The first token is the command name, the rest are its
+ * arguments. Tokens are separated by spaces.
+ * @param buf Frame
+ * @param len Length of frame
+ * @retval 0 Command handled
+ * @retval 1 Empty frame or unknown command
+ * @retval 2 Invalid number of arguments
+ */
+uint8_t CMD_Dispatch(const char* buf, uint16_t len) {
+
+  CMD_Token_TypeDef tokens[CMD_MAX_ARGS + 1];
+  const char* end = buf + len;
+  const CMD_Command_TypeDef* cmd;
+  uint8_t count = 0;
+  uint8_t lo = 0;
+  uint8_t hi = commandCount;
+  uint8_t mid;
+  int ret;
+
+  // split frame - one token more than allowed catches too many arguments
+  while (buf < end && count < CMD_MAX_ARGS + 1) {
+
+    while (buf < end && *buf == ' ') {
+      buf++;
+    }
+    if (buf == end) {
+      break;
+    }
+
+    tokens[count].str = buf;
+    while (buf < end && *buf != ' ') {
+      buf++;
+    }
+    tokens[count].len = buf - tokens[count].str;
+    count++;
+  }
+
+  while (buf < end && *buf == ' ') {
+    buf++;
+  }
+
+  if (count == 0) {
+    return 1;
+  }
+
+  // binary search for the name
+  while (lo < hi) {
+
+    mid = (lo + hi) / 2;
+    cmd = &commands[mid];
+    ret = CMD_Compare(tokens[0].str, tokens[0].len, cmd);
+
+    if (ret == 0) {
+
+      // anything left in buf is a surplus argument
+      if (count - 1 < cmd->minArgs || count - 1 > cmd->maxArgs || buf < end) {
+        LOG_WRN("Invalid number of arguments");
+        return 2;
+      }
+
+      cmd->handler(count - 1, &tokens[1]);
+      return 0;
+    }
+
+    if (ret < 0) {
+      hi = mid;
+    } else {
+      lo = mid + 1;
+    }
+  }
+
+  LOG_WRN("Unknown command");
+  return 1;
+}
+/**
+ * @brief Compares a token with a string.
+ * @param token Token
+ * @param str Null terminated string
+ * @retval 1 Token equals string
+ * @retval 0 Token differs from string
+ */
+uint8_t CMD_TokenEquals(const CMD_Token_TypeDef* token, const char* str) {
+  return strncmp(token->str, str, token->len) == 0 && str[token->len] == 0;
+}
+
+/**
+ * @}
+ */
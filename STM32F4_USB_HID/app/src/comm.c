@@ -16,42 +16,77 @@
  */
 
 #include <comm.h>
-#include <fifo.h>
+#include <log.h>
+#include <format.h>
 // HAL
-#include <uart2.h>
-#include <stdio.h>
+#include <uart.h>
+#include <string.h>
 
-#ifndef DEBUG
-  #define DEBUG
-#endif
-
-#ifdef DEBUG
-  #define print(str, args...) printf("COMM--> "str"%s",##args,"\r")
-  #define println(str, args...) printf("COMM--> "str"%s",##args,"\r\n")
-#else
-  #define print(str, args...) (void)0
-  #define println(str, args...) (void)0
-#endif
+#define LOG_MODULE LOG_COMM ///< Module of log messages
 
 /**
  * @addtogroup COMM
  * @{
  */
 
-#define COMM_BUF_LEN     2048    ///< COMM buffer lengths
-#define COMM_TERMINATOR '\r'     ///< COMM frame terminator character
+#define COMM_BUF_LEN       2048  ///< Console buffer lengths
+#define COMM_TERMINATOR    '\r'  ///< Console frame terminator character
+#define COMM_REPORT_LEN    38    ///< Longest drop report (see COMM_ReportDrops)
+
+static uint8_t rxBuffer[COMM_BUF_LEN]; ///< Buffer for data received by console
+static uint8_t txBuffer[COMM_BUF_LEN]; ///< Buffer for data transmitted by console
+
+static COMM_TypeDef console; ///< Terminal port used by printf and main loop
+
+uint8_t   COMM_TxCallback(void* ctx, uint8_t* c);
+uint16_t  COMM_TxSpanCallback(void* ctx, uint8_t** data);
+void      COMM_TxDoneCallback(void* ctx, uint16_t len);
+void      COMM_RxCallback(void* ctx, uint8_t c);
+void      COMM_RxDmaCallback(void* ctx, uint16_t pos);
 
-static uint8_t rxBuffer[COMM_BUF_LEN]; ///< Buffer for received data.
-static uint8_t txBuffer[COMM_BUF_LEN]; ///< Buffer for transmitted data.
+/**
+ * @brief Add a COMM port.
+ * @details Several ports can run at the same time, each with its own
+ * FIFOs, frame index and statistics.
+ * @param comm Port with user fields filled in
+ */
+void COMM_Add(COMM_TypeDef* comm) {
+
+  // Initialize RX FIFO
+  comm->rxFifo.buf = comm->rxBuf;
+  comm->rxFifo.len = comm->bufLen;
+  FIFO_Add(&comm->rxFifo);
+
+  // Initialize TX FIFO
+  comm->txFifo.buf = comm->txBuf;
+  comm->txFifo.len = comm->bufLen;
+  FIFO_Add(&comm->txFifo);
+
+  COMM_FRAMES_Init(&comm->rxFrames);
+  comm->rxFrame.start = 0;
+  comm->rxFrame.len   = 0;
+  comm->rxFrame.error = 0;
+  comm->rxOverrun = 0;
+  comm->rxResync  = 0;
+  comm->txDropped = 0;
 
-static FIFO_TypeDef rxFifo; ///< RX FIFO
-static FIFO_TypeDef txFifo; ///< TX FIFO
+  // pass baud rate
+  // callback for received data and callback for
+  // transmitted data (FIFOs have to be ready before
+  // the first interrupt)
+  COMM_HAL_Init(comm->port, comm->baud, comm, COMM_RxCallback, COMM_TxCallback);
 
-static uint8_t gotFrame;  ///< Nonzero signals a new frame (number of received frames)
+#if COMM_HAL_TX_DMA
+  // transmit whole blocks of TX FIFO
+  COMM_HAL_InitTxDma(comm->port, COMM_TxSpanCallback, COMM_TxDoneCallback);
+#endif
 
-uint8_t COMM_TxCallback(uint8_t* c);
-void    COMM_RxCallback(uint8_t c);
+#if COMM_HAL_RX_DMA
+  // DMA writes straight into RX FIFO buffer
+  COMM_HAL_InitRxDma(comm->port, comm->rxBuf, comm->bufLen, COMM_RxDmaCallback);
+#endif
 
+}
 /**
  * @brief Initialize communication terminal interface.
  *
@@ -59,130 +94,641 @@ void    COMM_RxCallback(uint8_t c);
  */
 void COMM_Init(uint32_t baud) {
 
-  // pass baud rate
-  // callback for received data and callback for
-  // transmitted data
-  COMM_HAL_Init(baud, COMM_RxCallback, COMM_TxCallback);
+  console.port       = COMM_HAL_CONSOLE;
+  console.baud       = baud;
+  console.rxBuf      = rxBuffer;
+  console.txBuf      = txBuffer;
+  console.bufLen     = COMM_BUF_LEN;
+  console.terminator = COMM_TERMINATOR;
 
-  // Initialize RX FIFO
-  rxFifo.buf = rxBuffer;
-  rxFifo.len = COMM_BUF_LEN;
-  FIFO_Add(&rxFifo);
+  COMM_Add(&console);
+}
+/**
+ * @brief Sets the function called when terminal frames arrive.
+ * @details The function runs in interrupt - it should only signal
+ * the code reading the frames (see SCHED_Notify).
+ * @param callback Function (NULL - none)
+ * @param ctx Passed to callback
+ */
+void COMM_SetFrameCallback(void (*callback)(void*), void* ctx) {
+  console.frameCtx = ctx;
+  console.frameCallback = callback;
+}
+/**
+ * @brief Reports dropped TX bytes once there is room for the report.
+ * @details The report is built by hand and pushed straight to the
+ * TX FIFO, so an overflow never goes back through printf. Binary
+ * ports only count the dropped bytes - text would corrupt the stream.
+ * @param comm COMM port
+ */
+static void COMM_ReportDrops(COMM_TypeDef* comm) {
 
-  // Initialize TX FIFO
-  txFifo.buf = txBuffer;
-  txFifo.len = COMM_BUF_LEN;
-  FIFO_Add(&txFifo);
+  static const char prefix[] = "\r\nCOMM--> ";
+  static const char suffix[] = " bytes dropped\r\n";
+  uint8_t msg[sizeof(prefix) + 10 + sizeof(suffix)];
+  uint8_t digits[10];
+  uint8_t len;
+  uint8_t n = 0;
+  uint32_t val = comm->txDropped;
+
+  (void)sizeof(char[sizeof(msg) <= COMM_REPORT_LEN ? 1 : -1]); // see COMM_PortTxFree
+
+  if (comm->binary) {
+    return;
+  }
+
+  // wait until a report of any length fits
+  if (FIFO_Count(&comm->txFifo) + sizeof(msg) > comm->bufLen) {
+    return;
+  }
 
+  do {
+    digits[n++] = '0' + val % 10;
+    val /= 10;
+  } while (val);
+
+  memcpy(msg, prefix, sizeof(prefix) - 1);
+  len = sizeof(prefix) - 1;
+  while (n) {
+    msg[len++] = digits[--n];
+  }
+  memcpy(&msg[len], suffix, sizeof(suffix) - 1);
+  len += sizeof(suffix) - 1;
+
+  FIFO_PushBlock(&comm->txFifo, msg, len);
+  comm->txDropped = 0;
 }
 /**
- * @brief Send a char to USART2.
- * @details This function can be called in stubs.c _write
- * function in order for printf to work
+ * @brief Send a char to a COMM port.
+ * @details If the TX FIFO is full the char is dropped and counted.
+ * The number of dropped chars is reported once when space frees up.
  *
+ * @param comm COMM port
+ * @param c Char to send.
+ */
+void COMM_PortPutc(COMM_TypeDef* comm, uint8_t c) {
+
+  if (comm->txDropped) {
+    COMM_ReportDrops(comm);
+  }
+
+  // The FIFO is lock free (we are the only producer, the IRQ
+  // is the only consumer), so no need to disable the IRQ here.
+  if (FIFO_Push(&comm->txFifo,c)) { // Put data in TX buffer
+    comm->txDropped++;
+  }
+  COMM_HAL_TxEnable(comm->port);  // Enable low level transmitter
+}
+/**
+ * @brief Send a block of data to a COMM port.
+ * @details The data is copied into the TX FIFO with at most two
+ * memcpy calls and the transmitter is enabled once. If only part of
+ * the data fits, the number of queued bytes is returned and the caller
+ * can retry the rest. If nothing fits the bytes are dropped and
+ * counted like in COMM_PortPutc.
+ * @param comm COMM port
+ * @param data Data to send
+ * @param len Length of data
+ * @return Number of bytes queued
+ */
+uint16_t COMM_PortWrite(COMM_TypeDef* comm, const uint8_t* data, uint16_t len) {
+
+  uint16_t n;
+
+  if (comm->txDropped) {
+    COMM_ReportDrops(comm);
+  }
+
+  // lock free FIFO - no need to disable the IRQ here either
+  n = FIFO_PushBlock(&comm->txFifo, data, len);
+
+  if (n == 0) {
+    comm->txDropped += len;
+  } else {
+    COMM_HAL_TxEnable(comm->port);  // Enable low level transmitter
+  }
+
+  return n;
+}
+/**
+ * @brief Gives the formatter the next free part of the TX FIFO.
+ * @param sink Formatter output (ctx is the COMM port)
+ * @retval 0 New buffer available
+ * @retval 1 TX FIFO full
+ */
+static uint8_t COMM_FormatRefill(FORMAT_Sink_TypeDef* sink) {
+
+  COMM_TypeDef* comm = sink->ctx;
+  uint8_t* data;
+
+  FIFO_Commit(&comm->txFifo, sink->buf - sink->start); // publish what's done
+  sink->room  = FIFO_Reserve(&comm->txFifo, UINT16_MAX, &data);
+  sink->start = (char*)data;
+  sink->buf   = (char*)data;
+
+  return sink->room == 0;
+}
+/**
+ * @brief Print formatted data to a COMM port.
+ * @details Formats straight into the TX FIFO using FORMAT_Vprint,
+ * without an intermediate buffer. Characters that don't fit are
+ * dropped and counted like in COMM_PortPutc.
+ * @warning Like all TX functions call only from one context
+ * (the TX FIFO has a single producer).
+ * @param comm COMM port
+ * @param fmt Format string (see format.h)
+ * @param args Arguments
+ * @return Number of characters queued
+ */
+uint16_t COMM_PortVprintf(COMM_TypeDef* comm, const char* fmt, va_list args) {
+
+  FORMAT_Sink_TypeDef sink;
+
+  if (comm->txDropped) {
+    COMM_ReportDrops(comm);
+  }
+
+  sink.ctx     = comm;
+  sink.refill  = COMM_FormatRefill;
+  sink.written = 0;
+  sink.dropped = 0;
+  sink.room    = FIFO_Reserve(&comm->txFifo, UINT16_MAX, (uint8_t**)&sink.start);
+  sink.buf     = sink.start;
+
+  FORMAT_Vprint(&sink, fmt, args);
+
+  FIFO_Commit(&comm->txFifo, sink.buf - sink.start);
+  comm->txDropped += sink.dropped;
+
+  if (sink.written) {
+    COMM_HAL_TxEnable(comm->port);  // Enable low level transmitter
+  }
+
+  return sink.written;
+}
+/**
+ * @brief Print formatted data to a COMM port.
+ * @param comm COMM port
+ * @param fmt Format string (see format.h)
+ * @return Number of characters queued
+ */
+uint16_t COMM_PortPrintf(COMM_TypeDef* comm, const char* fmt, ...) {
+
+  va_list args;
+  uint16_t n;
+
+  va_start(args, fmt);
+  n = COMM_PortVprintf(comm, fmt, args);
+  va_end(args);
+
+  return n;
+}
+/**
+ * @brief Print formatted data to the terminal.
+ * @details Replaces printf in the print macros of all modules.
+ * @param fmt Format string (see format.h)
+ * @return Number of characters queued
+ */
+uint16_t COMM_Printf(const char* fmt, ...) {
+
+  va_list args;
+  uint16_t n;
+
+  va_start(args, fmt);
+  n = COMM_PortVprintf(&console, fmt, args);
+  va_end(args);
+
+  return n;
+}
+/**
+ * @brief Print formatted data to the terminal.
+ * @param fmt Format string (see format.h)
+ * @param args Arguments
+ * @return Number of characters queued
+ */
+uint16_t COMM_Vprintf(const char* fmt, va_list args) {
+  return COMM_PortVprintf(&console, fmt, args);
+}
+/**
+ * @brief Send a char to the terminal.
+ * @details This function can be called in stubs.c _write
+ * function in order for printf to work.
  * @param c Char to send.
  */
 void COMM_Putc(uint8_t c) {
-  // disable IRQ so it doesn't screw up FIFO count - leads to errors in transmission
-  COMM_HAL_IrqDisable;
+  COMM_PortPutc(&console, c);
+}
+/**
+ * @brief Returns free space in the TX FIFO of a COMM port.
+ * @details A pending drop report is queued by the next write before
+ * its data, so the room it needs is not counted as free.
+ * @param comm COMM port
+ * @return Number of bytes that can be queued without dropping
+ */
+uint16_t COMM_PortTxFree(COMM_TypeDef* comm) {
 
-  FIFO_Push(&txFifo,c); // Put data in TX buffer
-  COMM_HAL_TxEnable();  // Enable low level transmitter
+  uint16_t free = comm->txFifo.len - FIFO_Count(&comm->txFifo);
 
-  // enable IRQ again
-  COMM_HAL_IrqEnable;
+  if (comm->txDropped && !comm->binary) {
+    free = free > COMM_REPORT_LEN ? free - COMM_REPORT_LEN : 0;
+  }
+
+  return free;
+}
+/**
+ * @brief Returns free space in the TX FIFO of the terminal.
+ * @return Number of bytes that can be queued without dropping
+ */
+uint16_t COMM_TxFree(void) {
+  return COMM_PortTxFree(&console);
+}
+/**
+ * @brief Send a block of data to the terminal.
+ * @details Used by stubs.c _write, so printf output is queued
+ * as a whole.
+ * @param data Data to send
+ * @param len Length of data
+ * @return Number of bytes queued (see COMM_PortWrite)
+ */
+uint16_t COMM_Write(const uint8_t* data, uint16_t len) {
+  return COMM_PortWrite(&console, data, len);
 }
 /**
- * @brief Get a char from USART2
+ * @brief Get a char from a COMM port
+ * @param comm COMM port
  * @return Received char.
  * @warning Blocking function! Waits until char is received.
+ * Don't mix with the frame functions - frames are resynchronized,
+ * but the one the char was taken from is lost.
  */
-uint8_t COMM_Getc(void) {
+uint8_t COMM_PortGetc(COMM_TypeDef* comm) {
 
   uint8_t c;
 
-  while (FIFO_IsEmpty(&rxFifo) == 1); // wait until buffer is not empty
+  while (FIFO_IsEmpty(&comm->rxFifo) == 1); // wait until buffer is not empty
   // buffer not empty => char was received
 
-//  USART_ITConfig(USART2, USART_IT_RXNE, DISABLE); // disable RX interrupt
+  FIFO_Pop(&comm->rxFifo,&c); // Get data from RX buffer
 
-  FIFO_Pop(&rxFifo,&c); // Get data from RX buffer
+  return c;
+}
+/**
+ * @brief Get a char from the terminal
+ * @return Received char.
+ * @warning Blocking function! Waits until char is received.
+ */
+uint8_t COMM_Getc(void) {
+  return COMM_PortGetc(&console);
+}
+/**
+ * @brief Get a view of the oldest complete frame (nonblocking).
+ * @details The frame is not copied - the view points into the RX FIFO.
+ * If the frame wraps around the end of the buffer it is split in two
+ * parts, otherwise the second part is empty. The view stays valid
+ * until COMM_PortReleaseFrame is called. Invalid frames (too long or
+ * with lost bytes) are dropped.
+ * @param comm COMM port
+ * @param view Frame view (terminator not included)
+ * @retval 0 Received frame
+ * @retval 1 No frame in buffer
+ * @retval 2 Frame error (frame was dropped)
+ */
+uint8_t COMM_PortPeekFrame(COMM_TypeDef* comm, COMM_FrameView_TypeDef* view) {
+
+  FIFO_TypeDef* rxFifo = &comm->rxFifo;
+  COMM_Frame_TypeDef* frame = COMM_FRAMES_Front(&comm->rxFrames);
+  uint8_t* data;
+  uint16_t first;
+  uint16_t len;
+
+  // DMA overwrote unread data - throw away everything received so far
+  if (comm->rxOverrun) {
+    FIFO_Consume(rxFifo, FIFO_Count(rxFifo));
+    while (COMM_FRAMES_Pop(&comm->rxFrames, NULL) == 0);
+    comm->rxResync = 1; // before clearing rxOverrun - the callback checks it first
+    comm->rxOverrun = 0;
+    LOG_LIMITED(LOG_WARN, 1000, "RX overrun");
+    return 2;
+  }
 
-//  USART_ITConfig(USART2, USART_IT_RXNE, ENABLE); // enable RX interrupt
+  if (frame == NULL) {
+    return 1;
+  }
 
-  return c;
+  // Skip bytes between frames (if an index entry was lost).
+  if ((int16_t)(frame->start - rxFifo->tail) > 0) {
+    FIFO_Consume(rxFifo, frame->start - rxFifo->tail);
+  }
+
+  // drop the frame if part of it was taken with COMM_PortGetc
+  if (frame->error || rxFifo->tail != frame->start) {
+    LOG_LIMITED(LOG_WARN, 1000, "Invalid frame");
+    COMM_PortReleaseFrame(comm);
+    return 2;
+  }
+
+  len = frame->len - 1; // without terminator
+  first = FIFO_Peek(rxFifo, &data);
+
+  if (first > len) {
+    first = len;
+  }
+
+  view->data[0] = data;
+  view->len[0]  = first;
+  view->data[1] = comm->rxBuf; // rest of the frame after the wrap point
+  view->len[1]  = len - first;
+
+  return 0;
 }
 /**
- * @brief Get a complete frame from USART2 (nonblocking)
+ * @brief Get a view of the oldest complete terminal frame (nonblocking).
+ * @param view Frame view (terminator not included)
+ * @return See COMM_PortPeekFrame
+ */
+uint8_t COMM_PeekFrame(COMM_FrameView_TypeDef* view) {
+  return COMM_PortPeekFrame(&console, view);
+}
+/**
+ * @brief Releases the frame returned by COMM_PortPeekFrame.
+ * @param comm COMM port
+ */
+void COMM_PortReleaseFrame(COMM_TypeDef* comm) {
+
+  COMM_Frame_TypeDef frame;
+  uint16_t end;
+
+  if (COMM_FRAMES_Pop(&comm->rxFrames, &frame) == 0) {
+    end = frame.start + frame.len;
+    // release everything up to the end of the frame
+    if ((int16_t)(end - comm->rxFifo.tail) > 0) {
+      FIFO_Consume(&comm->rxFifo, end - comm->rxFifo.tail);
+    }
+  }
+}
+/**
+ * @brief Releases the frame returned by COMM_PeekFrame.
+ */
+void COMM_ReleaseFrame(void) {
+  COMM_PortReleaseFrame(&console);
+}
+/**
+ * @brief Get a complete frame from a COMM port (nonblocking)
+ * @details The frame is copied with at most two memcpy calls.
+ * @param comm COMM port
  * @param buf Buffer for data (data will be null terminated for easier string manipulation)
  * @param len Length not including terminator character
+ * @param maxLen Size of buf (frames that don't fit are dropped)
  * @retval 0 Received frame
  * @retval 1 No frame in buffer
  * @retval 2 Frame error
- * TODO Add maximum length checking so as not to overflow
  */
-uint8_t COMM_GetFrame(uint8_t* buf, uint8_t* len) {
+uint8_t COMM_PortGetFrame(COMM_TypeDef* comm, uint8_t* buf, uint16_t* len,
+    uint16_t maxLen) {
+
+  COMM_FrameView_TypeDef view;
+  uint8_t ret;
 
-  uint8_t c;
   *len = 0; // zero out length variable
 
-  if (gotFrame) {
-    while (1) {
+  ret = COMM_PortPeekFrame(comm, &view);
 
-      // no more data and terminator wasn't reached => error
-      if (FIFO_IsEmpty(&rxFifo)) {
-        *len = 0;
-        println("Invalid frame");
-        return 2;
-      }
-      FIFO_Pop(&rxFifo, &c);
-      buf[(*len)++] = c;
-
-      // if end of frame
-      if (c == COMM_TERMINATOR) {
-        (*len)--; // length without terminator character
-        buf[*len] = 0; // USART terminator character converted to NULL terminator
-        break;
-      }
+  if (ret) {
+    return ret;
+  }
 
-    }
-    gotFrame--;
-    return 0;
+  // leave room for NULL terminator
+  if (view.len[0] + view.len[1] >= maxLen) {
+    LOG_LIMITED(LOG_WARN, 1000, "Frame too long");
+    COMM_PortReleaseFrame(comm);
+    return 2;
+  }
 
-  } else {
+  memcpy(buf, view.data[0], view.len[0]);
+  memcpy(&buf[view.len[0]], view.data[1], view.len[1]);
+  *len = view.len[0] + view.len[1];
+  buf[*len] = 0; // USART terminator character converted to NULL terminator
 
-    return 1;
-  }
+  COMM_PortReleaseFrame(comm);
+
+  return 0;
+}
+/**
+ * @brief Get a complete frame from the terminal (nonblocking)
+ * @param buf Buffer for data (null terminated)
+ * @param len Length not including terminator character
+ * @param maxLen Size of buf
+ * @return See COMM_PortGetFrame
+ */
+uint8_t COMM_GetFrame(uint8_t* buf, uint16_t* len, uint16_t maxLen) {
+  return COMM_PortGetFrame(&console, buf, len, maxLen);
+}
+/**
+ * @brief Print the RX and TX FIFO and line statistics of a port.
+ * @details Use it to size the buffers - the peak shows the
+ * highest occupancy and drops the number of lost bytes. Line errors
+ * show a saturated or misconfigured link. Printed on the terminal.
+ * @param comm COMM port
+ */
+void COMM_PortPrintStats(COMM_TypeDef* comm) {
+
+#if FIFO_STATS
+  FIFO_Stats_TypeDef rx, tx;
+
+  // take a snapshot first, printing changes TX statistics
+  FIFO_GetStats(&comm->rxFifo, &rx);
+  FIFO_GetStats(&comm->txFifo, &tx);
 
+  COMM_Printf("COMM--> Port %u RX peak %u/%u pushes %u pops %u drops %u\r\n",
+      (unsigned)comm->port, (unsigned)rx.peak, (unsigned)comm->bufLen,
+      (unsigned)rx.pushes, (unsigned)rx.pops, (unsigned)rx.drops);
+  COMM_Printf("COMM--> Port %u TX peak %u/%u pushes %u pops %u drops %u\r\n",
+      (unsigned)comm->port, (unsigned)tx.peak, (unsigned)comm->bufLen,
+      (unsigned)tx.pushes, (unsigned)tx.pops, (unsigned)tx.drops);
+#else
+  COMM_Printf("COMM--> FIFO statistics disabled\r\n");
+#endif
+
+  COMM_HAL_Stats_TypeDef line;
+
+  COMM_HAL_GetStats(comm->port, &line);
+
+  COMM_Printf("COMM--> Port %u line RX %u TX %u overrun %u framing %u noise %u parity %u\r\n",
+      (unsigned)comm->port, (unsigned)line.rxBytes, (unsigned)line.txBytes,
+      (unsigned)line.overruns, (unsigned)line.framing, (unsigned)line.noise,
+      (unsigned)line.parity);
+}
+/**
+ * @brief Print the terminal statistics.
+ */
+void COMM_PrintStats(void) {
+  COMM_PortPrintStats(&console);
 }
 /**
  * @brief Callback for receiving data from PC.
+ * @details Frame boundaries are recorded as the data arrives, so
+ * frames can be located without scanning the RX FIFO. Bytes of
+ * frames longer than COMM_MAX_FRAME_LEN are not stored.
+ * @param ctx COMM port
  * @param c Data sent from lower layer software.
  */
-void COMM_RxCallback(uint8_t c) {
+void COMM_RxCallback(void* ctx, uint8_t c) {
+
+  COMM_TypeDef* comm = ctx;
+  COMM_Frame_TypeDef* rxFrame = &comm->rxFrame;
+
+  if (c == comm->terminator) {
+
+    if (FIFO_Push(&comm->rxFifo, c) == 0) { // store terminator
+      rxFrame->len++;
+    } else {
+      rxFrame->error = 1;
+    }
+
+    // If there is no room for the entry the frame is lost,
+    // the reader skips its bytes using the start of the next one.
+    COMM_FRAMES_Push(&comm->rxFrames, rxFrame);
 
-  uint8_t res = FIFO_Push(&rxFifo, c); // Put data in RX buffer
+    // next frame starts right after this one
+    rxFrame->start += rxFrame->len;
+    rxFrame->len   = 0;
+    rxFrame->error = 0;
 
-  // Checking res to ensure no buffer overflow occurred
-  if ((c == COMM_TERMINATOR) && (res == 0)) {
-    gotFrame++;
+    if (comm->frameCallback != NULL) {
+      comm->frameCallback(comm->frameCtx);
+    }
+
+  } else if (rxFrame->len >= COMM_MAX_FRAME_LEN) {
+    rxFrame->error = 1; // frame too long - drop the rest
+  } else if (FIFO_Push(&comm->rxFifo, c) == 0) { // Put data in RX buffer
+    rxFrame->len++;
+  } else { // buffer overflow
+    rxFrame->error = 1;
+  }
+}
+/**
+ * @brief Callback for data received by circular DMA.
+ * @details The DMA writes straight into the RX FIFO buffer, so the
+ * new data only has to be scanned for terminators and committed.
+ * Frames longer than COMM_MAX_FRAME_LEN are marked invalid. If the DMA
+ * overtook the reader nothing more is committed until the reader
+ * flushes the whole RX FIFO. Then the data written by the DMA in the
+ * meantime is skipped and the first frame after it is marked invalid.
+ * @param ctx COMM port
+ * @param pos Buffer index of the next byte DMA will write
+ */
+void COMM_RxDmaCallback(void* ctx, uint16_t pos) {
+
+  COMM_TypeDef* comm = ctx;
+  FIFO_TypeDef* rxFifo = &comm->rxFifo;
+  COMM_Frame_TypeDef* rxFrame = &comm->rxFrame;
+  uint16_t n = (pos - rxFifo->head) & rxFifo->mask; // new bytes
+  uint16_t offset;
+  uint16_t chunk;
+  uint16_t k;
+  uint8_t* data;
+  uint8_t* end;
+  uint8_t frames = 0;
+
+  if (comm->rxOverrun) { // waiting for the reader to flush
+    return;
+  }
+
+  if (comm->rxResync) {
+    // Data written since the overrun is partly overwritten - commit it
+    // without looking for frames, the reader skips it as bytes between
+    // frames. The next frame starts in the middle, so it is invalid.
+    FIFO_Commit(rxFifo, n);
+    rxFrame->start = rxFifo->head;
+    rxFrame->len   = 0;
+    rxFrame->error = 1;
+    comm->rxResync = 0;
+    return;
+  }
+
+  if (n > rxFifo->len - FIFO_Count(rxFifo)) {
+    comm->rxOverrun = 1;
+    rxFrame->error = 1;
+    return;
+  }
+
+  // at most two passes - before and after the wrap point
+  while (n) {
+
+    offset = rxFifo->head & rxFifo->mask;
+    chunk = rxFifo->len - offset;
+    if (chunk > n) {
+      chunk = n;
+    }
+
+    data = &comm->rxBuf[offset];
+    k = chunk;
+
+    // record every frame ending in this chunk
+    while ((end = memchr(data, comm->terminator, k)) != NULL) {
+
+      rxFrame->len += end - data + 1;
+      if (rxFrame->len > COMM_MAX_FRAME_LEN + 1) {
+        rxFrame->error = 1;
+      }
+      COMM_FRAMES_Push(&comm->rxFrames, rxFrame);
+      frames = 1;
+
+      rxFrame->start += rxFrame->len;
+      rxFrame->len   = 0;
+      rxFrame->error = 0;
+
+      k -= end - data + 1;
+      data = end + 1;
+    }
+    rxFrame->len += k; // start of next frame
+    if (rxFrame->len > COMM_MAX_FRAME_LEN + 1) {
+      rxFrame->error = 1; // latched before len can wrap
+    }
+
+    FIFO_Commit(rxFifo, chunk);
+    n -= chunk;
+  }
+
+  if (frames && comm->frameCallback != NULL) {
+    comm->frameCallback(comm->frameCtx);
   }
 }
 /**
  * @brief Callback for transmitting data to lower layer
+ * @param ctx COMM port
  * @param c Transmitted data
  * @retval 0 There is no more data in buffer (stop transmitting)
  * @retval 1 Valid data in c
  */
-uint8_t COMM_TxCallback(uint8_t* c) {
+uint8_t COMM_TxCallback(void* ctx, uint8_t* c) {
 
-  if (FIFO_Pop(&txFifo, c) == 0) { // If buffer not empty
+  if (FIFO_Pop(&((COMM_TypeDef*)ctx)->txFifo, c) == 0) { // If buffer not empty
     return 1;
   } else {
     return 0;
   }
 
 }
+/**
+ * @brief Callback for transmitting data to lower layer in blocks
+ * @details Used by DMA transmission. The block stays in TX FIFO until
+ * COMM_TxDoneCallback is called.
+ * @param ctx COMM port
+ * @param data Set to the first byte to transmit
+ * @return Number of contiguous bytes to transmit (0 - stop transmitting)
+ */
+uint16_t COMM_TxSpanCallback(void* ctx, uint8_t** data) {
+  return FIFO_Peek(&((COMM_TypeDef*)ctx)->txFifo, data);
+}
+/**
+ * @brief Callback for releasing data transmitted by lower layer
+ * @param ctx COMM port
+ * @param len Number of transmitted bytes
+ */
+void COMM_TxDoneCallback(void* ctx, uint16_t len) {
+  FIFO_Consume(&((COMM_TypeDef*)ctx)->txFifo, len);
+}
 
 /**
  * @}
@@ -16,51 +16,125 @@
  */
 
 #include <fifo.h>
-#include <stdio.h>
+#include <log.h>
+#include <timers.h>
+#include <string.h>
 
-#ifndef DEBUG
-  #define DEBUG
-#endif
+#define LOG_MODULE LOG_FIFO ///< Module of log messages
+
+/**
+ * @addtogroup FIFO
+ * @{
+ */
+
+/**
+ * @brief Compiler barrier.
+ * @details Makes sure the buffer access is finished before the
+ * index is published to the other side of the FIFO. A single Cortex-M4
+ * core sees its own stores in order, so no DMB is needed.
+ */
+#define FIFO_BARRIER() __asm volatile ("" : : : "memory")
 
-#ifdef DEBUG
-  #define print(str, args...) printf("FIFO--> "str"%s",##args,"\r")
-  #define println(str, args...) printf("FIFO--> "str"%s",##args,"\r\n")
+#if FIFO_STATS
+  #define FIFO_STAT_ADD(fifo, field, n) ((fifo)->stats.field += (n))
+  #define FIFO_STAT_PEAK(fifo)          FIFO_UpdatePeak(fifo)
 #else
-  #define print(str, args...) (void)0
-  #define println(str, args...) (void)0
+  #define FIFO_STAT_ADD(fifo, field, n) (void)0
+  #define FIFO_STAT_PEAK(fifo)          (void)0
 #endif
 
+#if FIFO_STATS
 /**
- * @addtogroup FIFO
- * @{
+ * @brief Updates the occupancy high watermark (producer side).
+ * @param fifo Pointer to FIFO structure
+ */
+static inline void FIFO_UpdatePeak(FIFO_TypeDef* fifo) {
+
+  uint16_t count = (uint16_t)(fifo->head - fifo->tail);
+
+  if (count > fifo->stats.peak) {
+    fifo->stats.peak = count;
+  }
+}
+#endif
+
+/**
+ * @brief Applies the overflow policy when the FIFO has less than
+ * needed bytes of free space.
+ * @param fifo Pointer to FIFO structure
+ * @param needed Number of bytes that have to fit (not more than len)
+ * @retval 0 There is room for the data now
+ * @retval 1 The data has to be dropped
  */
+static uint8_t FIFO_HandleOverflow(FIFO_TypeDef* fifo, uint16_t needed) {
+
+  uint16_t space;
+  uint64_t deadline;
+
+  switch (fifo->policy) {
+
+  case FIFO_POLICY_OVERWRITE:
+    space = fifo->len - (uint16_t)(fifo->head - fifo->tail);
+    if (needed > space) {
+      fifo->tail += needed - space; // drop oldest data
+      FIFO_STAT_ADD(fifo, drops, needed - space);
+    }
+    return 0;
+
+  case FIFO_POLICY_BLOCK:
+    deadline = TIMER_DeadlineAfter(fifo->timeout);
+    // wait for the consumer to make room
+    while (fifo->len - (uint16_t)(fifo->head - fifo->tail) < needed) {
+      if (TIMER_DeadlineExpired(deadline)) {
+        return 1;
+      }
+    }
+    return 0;
+
+  default:
+    return 1;
+  }
+}
 
 /**
  * @brief Add a FIFO.
  *
  * @details To add a FIFO, you need to define a FIFO_TypeDef
  * structure and initialize it with the proper length and
- * buffer pointer. The rest is handled automatically.
+ * buffer pointer. The policy and timeout fields may be set
+ * too. The rest is handled automatically.
  *
  * @param fifo Pointer to FIFO structure
  * @retval 0 FIFO added successfully
- * @retval 1 Error: FIFO length is 0
+ * @retval 1 Error: FIFO length is 0 or not a power of two
  */
 uint8_t FIFO_Add(FIFO_TypeDef* fifo) {
 
   if (fifo->len == 0 ) {
-    println("Zero FIFO length");
+    LOG_ERR("Zero FIFO length");
+    return 1;
+  }
+
+  // indices are 16 bit and free running, so the length has to
+  // divide 65536 and leave room to tell full from empty
+  if ((fifo->len & (fifo->len - 1)) != 0 || fifo->len > 0x8000) {
+    LOG_ERR("FIFO length %d is not a power of two", (int)fifo->len);
     return 1;
   }
 
   fifo->tail  = 0;
   fifo->head  = 0;
-  fifo->count = 0;
+  fifo->mask  = fifo->len - 1;
+
+#if FIFO_STATS
+  FIFO_ClearStats(fifo);
+#endif
 
   return 0;
 }
 /**
  * @brief Pushes data to FIFO.
+ * @details Call only from the producer side.
  * @param fifo Pointer to FIFO structure
  * @param c Data byte
  * @retval 0 Data added
@@ -69,23 +143,27 @@ uint8_t FIFO_Add(FIFO_TypeDef* fifo) {
 uint8_t FIFO_Push(FIFO_TypeDef* fifo, uint8_t c) {
 
   // Check for overflow
-  if (fifo->count == fifo->len) {
-    println("FIFO overflow");
+  if ((uint16_t)(fifo->head - fifo->tail) == fifo->len &&
+      FIFO_HandleOverflow(fifo, 1)) {
+    // no printing here - the FIFO may be the one printf writes to
+    FIFO_STAT_ADD(fifo, drops, 1);
     return 1;
   }
 
-  fifo->buf[fifo->head++] = c; // Put char in buffer
-  fifo->count++; // Increase counter
+  uint16_t head = fifo->head;
 
+  fifo->buf[head & fifo->mask] = c; // Put char in buffer
+  FIFO_BARRIER();
+  fifo->head = head + 1; // Publish new data to consumer
 
-  if (fifo->head == fifo->len) {
-    fifo->head = 0; // start from beginning
-  }
+  FIFO_STAT_ADD(fifo, pushes, 1);
+  FIFO_STAT_PEAK(fifo);
 
   return 0;
 }
 /**
  * @brief Pops data from the FIFO.
+ * @details Call only from the consumer side.
  * @param fifo Pointer to FIFO structure
  * @param c data
  * @retval 0 Got valid data
@@ -93,17 +171,19 @@ uint8_t FIFO_Push(FIFO_TypeDef* fifo, uint8_t c) {
  */
 uint8_t FIFO_Pop(FIFO_TypeDef* fifo, uint8_t* c) {
 
+  uint16_t tail = fifo->tail;
+
   // If FIFO is empty
-  if (fifo->count == 0) {
-//    println("FIFO is empty");
+  if (tail == fifo->head) {
+//    LOG_DBG("FIFO is empty");
     return 1;
   }
-  *c = fifo->buf[fifo->tail++];
-  fifo->count--;
 
-  if (fifo->tail == fifo->len) {
-    fifo->tail = 0; // start from beginning
-  }
+  *c = fifo->buf[tail & fifo->mask];
+  FIFO_BARRIER();
+  fifo->tail = tail + 1; // Release space to producer
+
+  FIFO_STAT_ADD(fifo, pops, 1);
 
   return 0;
 }
@@ -115,12 +195,208 @@ uint8_t FIFO_Pop(FIFO_TypeDef* fifo, uint8_t* c) {
  */
 uint8_t FIFO_IsEmpty(FIFO_TypeDef* fifo) {
 
-  if (fifo->count == 0) {
+  if (fifo->head == fifo->tail) {
     return 1;
   }
 
   return 0;
 }
+/**
+ * @brief Returns the number of bytes stored in the FIFO.
+ * @details The value is a snapshot - the other side may change it
+ * right after the call.
+ * @param fifo Pointer to FIFO structure
+ * @return Number of bytes in FIFO
+ */
+uint16_t FIFO_Count(FIFO_TypeDef* fifo) {
+  return (uint16_t)(fifo->head - fifo->tail);
+}
+/**
+ * @brief Pushes a block of data to the FIFO.
+ * @details Call only from the producer side. The data is copied
+ * with at most two memcpy calls (before and after the wrap point).
+ * If there is not enough space the overflow policy decides what is
+ * lost - with FIFO_POLICY_REJECT only the part that fits is pushed.
+ * @param fifo Pointer to FIFO structure
+ * @param data Data to push
+ * @param len Number of bytes to push
+ * @return Number of bytes actually pushed
+ */
+uint16_t FIFO_PushBlock(FIFO_TypeDef* fifo, const uint8_t* data, uint16_t len) {
+
+  uint8_t* dst;
+  uint16_t n;
+  uint16_t pushed = 0;
+  uint16_t space = fifo->len - (uint16_t)(fifo->head - fifo->tail);
+
+  if (len > space && fifo->policy == FIFO_POLICY_OVERWRITE) {
+    // only the newest len bytes can be kept
+    if (len > fifo->len) {
+      FIFO_STAT_ADD(fifo, drops, len - fifo->len);
+      pushed = len - fifo->len;
+    }
+    FIFO_HandleOverflow(fifo, len - pushed);
+  }
+
+  // at most two passes - before and after the wrap point
+  while (pushed < len) {
+
+    n = FIFO_Reserve(fifo, len - pushed, &dst);
+
+    if (n == 0) { // FIFO full
+      if (fifo->policy == FIFO_POLICY_BLOCK &&
+          FIFO_HandleOverflow(fifo, 1) == 0) {
+        continue;
+      }
+      FIFO_STAT_ADD(fifo, drops, len - pushed);
+      break;
+    }
+
+    memcpy(dst, data + pushed, n);
+    FIFO_Commit(fifo, n);
+    pushed += n;
+  }
+
+  return pushed;
+}
+/**
+ * @brief Pops a block of data from the FIFO.
+ * @details Call only from the consumer side. The data is copied
+ * with at most two memcpy calls (before and after the wrap point).
+ * @param fifo Pointer to FIFO structure
+ * @param data Buffer for data
+ * @param len Maximum number of bytes to pop
+ * @return Number of bytes actually popped
+ */
+uint16_t FIFO_PopBlock(FIFO_TypeDef* fifo, uint8_t* data, uint16_t len) {
+
+  uint16_t tail = fifo->tail;
+  uint16_t count = (uint16_t)(fifo->head - tail);
+
+  if (len > count) {
+    len = count;
+  }
+
+  uint16_t offset = tail & fifo->mask;
+  uint16_t first  = fifo->len - offset; // data until the wrap point
+
+  if (first > len) {
+    first = len;
+  }
+
+  memcpy(data, &fifo->buf[offset], first);
+  memcpy(data + first, fifo->buf, len - first);
+
+  FIFO_Consume(fifo, len); // Release space to producer
+
+  return len;
+}
+/**
+ * @brief Returns the contiguous readable part of the FIFO.
+ * @details Call only from the consumer side. The data can be
+ * processed in place and then released with FIFO_Consume. If
+ * the stored data wraps around the end of the buffer, only the part
+ * up to the wrap point is returned - call again after consuming
+ * it to get the rest.
+ * @param fifo Pointer to FIFO structure
+ * @param data Set to the first readable byte
+ * @return Number of contiguous readable bytes (0 if FIFO is empty)
+ */
+uint16_t FIFO_Peek(FIFO_TypeDef* fifo, uint8_t** data) {
+
+  uint16_t tail = fifo->tail;
+  uint16_t count = (uint16_t)(fifo->head - tail);
+  uint16_t offset = tail & fifo->mask;
+
+  if (count > fifo->len - offset) {
+    count = fifo->len - offset;
+  }
+
+  *data = &fifo->buf[offset];
+
+  return count;
+}
+/**
+ * @brief Releases data read in place after FIFO_Peek.
+ * @details Call only from the consumer side.
+ * @param fifo Pointer to FIFO structure
+ * @param len Number of bytes to release (not more than FIFO_Count)
+ */
+void FIFO_Consume(FIFO_TypeDef* fifo, uint16_t len) {
+
+  FIFO_BARRIER();
+  fifo->tail += len; // Release space to producer
+
+  FIFO_STAT_ADD(fifo, pops, len);
+}
+/**
+ * @brief Reserves a contiguous writable region of the FIFO.
+ * @details Call only from the producer side. The region can be filled
+ * directly (by DMA, a formatter, a USB read...) and then published
+ * with FIFO_Commit. Nothing is visible to the consumer until the
+ * commit. If the free space wraps around the end of the buffer,
+ * only the part up to the wrap point is returned - commit it and call
+ * again to get the rest.
+ * @param fifo Pointer to FIFO structure
+ * @param maxLen Maximum number of bytes needed
+ * @param data Set to the first writable byte
+ * @return Number of contiguous writable bytes (0 if FIFO is full)
+ */
+uint16_t FIFO_Reserve(FIFO_TypeDef* fifo, uint16_t maxLen, uint8_t** data) {
+
+  uint16_t head = fifo->head;
+  uint16_t space = fifo->len - (uint16_t)(head - fifo->tail);
+  uint16_t offset = head & fifo->mask;
+
+  if (space > fifo->len - offset) {
+    space = fifo->len - offset;
+  }
+
+  if (space > maxLen) {
+    space = maxLen;
+  }
+
+  *data = &fifo->buf[offset];
+
+  return space;
+}
+/**
+ * @brief Publishes data written to a region from FIFO_Reserve.
+ * @details Call only from the producer side.
+ * @param fifo Pointer to FIFO structure
+ * @param len Number of bytes written (not more than reserved)
+ */
+void FIFO_Commit(FIFO_TypeDef* fifo, uint16_t len) {
+
+  FIFO_BARRIER();
+  fifo->head += len; // Publish new data to consumer
+
+  FIFO_STAT_ADD(fifo, pushes, len);
+  FIFO_STAT_PEAK(fifo);
+}
+
+#if FIFO_STATS
+/**
+ * @brief Reads the FIFO statistics.
+ * @param fifo Pointer to FIFO structure
+ * @param stats Copy of the statistics
+ */
+void FIFO_GetStats(FIFO_TypeDef* fifo, FIFO_Stats_TypeDef* stats) {
+  *stats = fifo->stats;
+}
+/**
+ * @brief Zeroes out the FIFO statistics.
+ * @details The peak is set to the current occupancy.
+ * @param fifo Pointer to FIFO structure
+ */
+void FIFO_ClearStats(FIFO_TypeDef* fifo) {
+
+  fifo->stats.peak   = FIFO_Count(fifo);
+  fifo->stats.pushes = 0;
+  fifo->stats.pops   = 0;
+  fifo->stats.drops  = 0;
+}
+#endif
 
 /**
  * @}
@@ -0,0 +1,279 @@
+/**
+ * @file    format.c
+ * @brief   Integer only formatted output
+ * @date    17 paź 2026
+ * @author  Michal Ksiezopolski
+ *
+ * @verbatim
+ * Copyright (c) 2026 Michal Ksiezopolski.
+ * All rights reserved. This program and the
+ * accompanying materials are made available
+ * under the terms of the GNU Public License
+ * v3.0 which accompanies this distribution,
+ * and is available at
+ * http://www.gnu.org/licenses/gpl.html
+ * @endverbatim
+ */
+
+#include <format.h>
+
+/**
+ * @addtogroup FORMAT
+ * @{
+ */
+
+#define FORMAT_LEFT   0x01 ///< Left justify
+#define FORMAT_ZERO   0x02 ///< Pad with zeros
+#define FORMAT_UPPER  0x04 ///< Upper case hex digits
+
+/**
+ * @brief Writes a character to the sink.
+ * @param sink Output
+ * @param c Character
+ */
+static inline void FORMAT_Putc(FORMAT_Sink_TypeDef* sink, char c) {
+
+  if (sink->room == 0 && (sink->refill == 0 || sink->refill(sink))) {
+    sink->dropped++;
+    return;
+  }
+
+  *sink->buf++ = c;
+  sink->room--;
+  sink->written++;
+}
+/**
+ * @brief Writes a string padded to a field width.
+ * @param sink Output
+ * @param str String
+ * @param len Length of string
+ * @param width Field width
+ * @param flags Formatting flags
+ */
+static void FORMAT_Field(FORMAT_Sink_TypeDef* sink, const char* str,
+    uint16_t len, uint16_t width, uint8_t flags) {
+
+  uint16_t pad = width > len ? width - len : 0;
+
+  if (!(flags & FORMAT_LEFT)) {
+    while (pad) {
+      FORMAT_Putc(sink, ' ');
+      pad--;
+    }
+  }
+
+  while (len--) {
+    FORMAT_Putc(sink, *str++);
+  }
+
+  while (pad) { // left justified
+    FORMAT_Putc(sink, ' ');
+    pad--;
+  }
+}
+/**
+ * @brief Writes a number.
+ * @param sink Output
+ * @param val Absolute value
+ * @param neg Nonzero if value is negative
+ * @param base 10 or 16
+ * @param width Field width
+ * @param flags Formatting flags
+ */
+static void FORMAT_Number(FORMAT_Sink_TypeDef* sink, uint32_t val, uint8_t neg,
+    uint8_t base, uint16_t width, uint8_t flags) {
+
+  const char* digits = (flags & FORMAT_UPPER) ? "0123456789ABCDEF" : "0123456789abcdef";
+  char buf[11]; // 10 decimal digits and sign
+  uint8_t n = sizeof(buf);
+  uint16_t len;
+
+  do {
+    buf[--n] = digits[val % base];
+    val /= base;
+  } while (val);
+
+  len = sizeof(buf) - n + (neg ? 1 : 0);
+
+  if (flags & FORMAT_ZERO && !(flags & FORMAT_LEFT)) {
+    // sign goes before the zeros
+    if (neg) {
+      FORMAT_Putc(sink, '-');
+    }
+    while (width > len) {
+      FORMAT_Putc(sink, '0');
+      width--;
+    }
+    FORMAT_Field(sink, &buf[n], sizeof(buf) - n, 0, flags);
+    return;
+  }
+
+  if (neg) {
+    buf[--n] = '-';
+  }
+  FORMAT_Field(sink, &buf[n], sizeof(buf) - n, width, flags);
+}
+/**
+ * @brief Formats data into a sink.
+ * @param sink Output
+ * @param fmt Format string (see format.h for supported conversions)
+ * @param args Arguments
+ * @return Number of characters written (dropped ones not included)
+ */
+uint16_t FORMAT_Vprint(FORMAT_Sink_TypeDef* sink, const char* fmt, va_list args) {
+
+  uint16_t width;
+  uint8_t flags;
+  uint16_t len;
+  const char* str;
+  int32_t val;
+  char c;
+
+  while ((c = *fmt++) != 0) {
+
+    if (c != '%') {
+      FORMAT_Putc(sink, c);
+      continue;
+    }
+
+    flags = 0;
+    width = 0;
+
+    // flags
+    for (;;) {
+      if (*fmt == '-') {
+        flags |= FORMAT_LEFT;
+      } else if (*fmt == '0') {
+        flags |= FORMAT_ZERO;
+      } else {
+        break;
+      }
+      fmt++;
+    }
+
+    // width
+    if (*fmt == '*') {
+      val = va_arg(args, int);
+      if (val < 0) {
+        flags |= FORMAT_LEFT;
+        val = -val;
+      }
+      width = val;
+      fmt++;
+    } else {
+      while (*fmt >= '0' && *fmt <= '9') {
+        width = width * 10 + (*fmt++ - '0');
+      }
+    }
+
+    // length modifier - int and long are the same
+    while (*fmt == 'l') {
+      fmt++;
+    }
+
+    switch (c = *fmt++) {
+
+    case 'd':
+    case 'i':
+      val = va_arg(args, int);
+      if (val < 0) {
+        FORMAT_Number(sink, -(uint32_t)val, 1, 10, width, flags);
+      } else {
+        FORMAT_Number(sink, val, 0, 10, width, flags);
+      }
+      break;
+
+    case 'u':
+      FORMAT_Number(sink, va_arg(args, unsigned int), 0, 10, width, flags);
+      break;
+
+    case 'X':
+      flags |= FORMAT_UPPER;
+      // fall through
+    case 'x':
+      FORMAT_Number(sink, va_arg(args, unsigned int), 0, 16, width, flags);
+      break;
+
+    case 'c':
+      c = va_arg(args, int);
+      FORMAT_Field(sink, &c, 1, width, flags);
+      break;
+
+    case 's':
+      str = va_arg(args, const char*);
+      if (str == 0) {
+        str = "(null)";
+      }
+      for (len = 0; str[len]; len++);
+      FORMAT_Field(sink, str, len, width, flags);
+      break;
+
+    case '%':
+      FORMAT_Putc(sink, '%');
+      break;
+
+    case 0: // format ends with %
+      return sink->written;
+
+    default: // unsupported conversion - print as is
+      FORMAT_Putc(sink, '%');
+      FORMAT_Putc(sink, c);
+      break;
+    }
+  }
+
+  return sink->written;
+}
+/**
+ * @brief Formats data into a buffer.
+ * @details Output is always null terminated (if size is not 0)
+ * and truncated if it doesn't fit.
+ * @param buf Buffer
+ * @param size Size of buffer
+ * @param fmt Format string
+ * @param args Arguments
+ * @return Number of characters written (without null terminator)
+ */
+uint16_t FORMAT_Vsnprintf(char* buf, uint16_t size, const char* fmt, va_list args) {
+
+  FORMAT_Sink_TypeDef sink;
+
+  if (size == 0) {
+    return 0;
+  }
+
+  sink.start   = buf;
+  sink.buf     = buf;
+  sink.room    = size - 1; // room for null terminator
+  sink.written = 0;
+  sink.dropped = 0;
+  sink.refill  = 0;
+
+  FORMAT_Vprint(&sink, fmt, args);
+
+  *sink.buf = 0;
+
+  return sink.written;
+}
+/**
+ * @brief Formats data into a buffer.
+ * @param buf Buffer
+ * @param size Size of buffer
+ * @param fmt Format string
+ * @return Number of characters written (without null terminator)
+ */
+uint16_t FORMAT_Snprintf(char* buf, uint16_t size, const char* fmt, ...) {
+
+  va_list args;
+  uint16_t n;
+
+  va_start(args, fmt);
+  n = FORMAT_Vsnprintf(buf, size, fmt, args);
+  va_end(args);
+
+  return n;
+}
+
+/**
+ * @}
+ */
@@ -16,21 +16,12 @@
  */
 
 #include <keys.h>
+#include <log.h>
 #include <timers.h>
-#include <stdio.h>
+#include <trace.h>
 #include <keys_hal.h>
 
-#ifndef DEBUG
-  #define DEBUG
-#endif
-
-#ifdef DEBUG
-  #define print(str, args...) printf("KEYS--> "str"%s",##args,"\r")
-  #define println(str, args...) printf("KEYS--> "str"%s",##args,"\r\n")
-#else
-  #define print(str, args...) (void)0
-  #define println(str, args...) (void)0
-#endif
+#define LOG_MODULE LOG_KEYS ///< Module of log messages
 
 /**
  * @addtogroup KEYS
@@ -67,7 +58,8 @@ void KEYS_Init(void) {
 }
 /**
  * @brief Checks if any keys are set.
- * @details Run this function in main loop to check for pressed keys.
+ * @details Run this function every KEYS_SCAN_TIME ms (e.g. from a soft
+ * timer) to check for pressed keys.
  * TODO Add repeat, function calling
  */
 uint8_t KEYS_Update(void) {
@@ -78,15 +70,15 @@ uint8_t KEYS_Update(void) {
   uint8_t currentKey      = KEY_NONE; // stores temporary key received from HAL (may be glitch)
 
   static uint8_t repeatFlag = 0; // repeat flag
-  static uint32_t debounceTimer = 0; // timer for counting debounce time
-  static uint32_t repeatTimer = 0;
+  static uint64_t debounceDeadline = 0; // end of debounce time
+  static uint64_t repeatDeadline = 0;   // end of repeat time
 
   int8_t row = KEYS_HAL_ReadRow();
 
   // if a key press has been recognized
   if (row != -1) {
     currentKey = (currentColumn << 4) | row;
-  } else if (TIMER_DelayTimer(REPEAT_TIME, repeatTimer)) { // repeat timeout
+  } else if (TIMER_DeadlineExpired(repeatDeadline)) { // repeat timeout
     repeatFlag = 0;
     lastKey = KEY_NONE;
   }
@@ -95,12 +87,12 @@ uint8_t KEYS_Update(void) {
   if (keyId != currentKey && currentKey != KEY_NONE) {
 
     if (lastKey == currentKey &&
-        !TIMER_DelayTimer(REPEAT_TIME, repeatTimer)) { // if last key still pressed
+        !TIMER_DeadlineExpired(repeatDeadline)) { // if last key still pressed
       repeatFlag = 1;
-      repeatTimer = TIMER_GetTime();
+      repeatDeadline = TIMER_DeadlineAfter(REPEAT_TIME);
     } else { // new key
       keyId = currentKey; // store the new key
-      debounceTimer = TIMER_GetTime(); // start debounce timer
+      debounceDeadline = TIMER_DeadlineAfter(DEBOUNCE_TIME); // start debounce timer
       lastKey = KEY_NONE;
       repeatFlag = 0;
     }
@@ -108,12 +100,12 @@ uint8_t KEYS_Update(void) {
   }
   // if debounce finished, the key is valid
   if (!repeatFlag && keyId != KEY_NONE &&
-      TIMER_DelayTimer(DEBOUNCE_TIME, debounceTimer)) {
+      TIMER_DeadlineExpired(debounceDeadline)) {
     keyValid = keyId;
-    println("You pressed a key 0x%02x.", keyValid);
+    TRACE("You pressed a key 0x%02x.", keyValid);
     lastKey = keyId; // store new last pressed key
     keyId = KEY_NONE;
-    repeatTimer = TIMER_GetTime(); // start repeatTimer
+    repeatDeadline = TIMER_DeadlineAfter(REPEAT_TIME); // start repeat time
   } else if (repeatFlag) {
     keyValid = lastKey;
   }
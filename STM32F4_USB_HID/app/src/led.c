@@ -25,21 +25,11 @@
  *
  */
 
-#include <stdio.h>
+#include <log.h>
 #include <led.h>
 #include <led_hal.h>
 
-#ifndef DEBUG
-  #define DEBUG
-#endif
-
-#ifdef DEBUG
-  #define print(str, args...) printf("LED--> "str"%s",##args,"\r")
-  #define println(str, args...) printf("LED--> "str"%s",##args,"\r\n")
-#else
-  #define print(str, args...) (void)0
-  #define println(str, args...) (void)0
-#endif
+#define LOG_MODULE LOG_LED ///< Module of log messages
 
 /**
  * @addtogroup LED
@@ -56,7 +46,7 @@ void LED_Init(LED_Number_TypeDef led) {
 
   // Check if LED number is correct.
   if (led >= MAX_LEDS) {
-    println("Error: Incorrect LED number %d!", (int)led);
+    LOG_ERR("Incorrect LED number %d!", (int)led);
     return;
   }
 
@@ -72,12 +62,12 @@ void LED_Init(LED_Number_TypeDef led) {
 void LED_ChangeState(LED_Number_TypeDef led, LED_State_TypeDef state) {
 
   if (led >= MAX_LEDS) {
-    println("Error: Incorrect LED number %d!", (int)led);
+    LOG_ERR("Incorrect LED number %d!", (int)led);
     return;
   }
 
   if (ledState[led] == LED_UNUSED) {
-    println("Error: Uninitialized LED %d!", (int)led);
+    LOG_ERR("Uninitialized LED %d!", (int)led);
     return;
   } else {
     if (state == LED_OFF) {
@@ -97,12 +87,12 @@ void LED_ChangeState(LED_Number_TypeDef led, LED_State_TypeDef state) {
 void LED_Toggle(LED_Number_TypeDef led) {
 
   if (led >= MAX_LEDS) {
-    println("Error: Incorrect LED number %d!", (int)led);
+    LOG_ERR("Incorrect LED number %d!", (int)led);
     return;
   }
 
   if (ledState[led] == LED_UNUSED) {
-    println("Error: Uninitialized LED %d!", (int)led);
+    LOG_ERR("Uninitialized LED %d!", (int)led);
     return;
   } else {
     if (ledState[led] == LED_OFF) {
@@ -0,0 +1,388 @@
+/**
+ * @file    log.c
+ * @brief   Logging with per module levels
+ * @date    17 paź 2026
+ * @author  Michal Ksiezopolski
+ *
+ * @verbatim
+ * Copyright (c) 2026 Michal Ksiezopolski.
+ * All rights reserved. This program and the
+ * accompanying materials are made available
+ * under the terms of the GNU Public License
+ * v3.0 which accompanies this distribution,
+ * and is available at
+ * http://www.gnu.org/licenses/gpl.html
+ * @endverbatim
+ */
+
+#include <log.h>
+#include <comm.h>
+#include <cmd.h>
+#include <format.h>
+#include <timers.h>
+// HAL
+#include <cpu_hal.h>
+#include <itm_hal.h>
+#include <stdarg.h>
+
+/**
+ * @addtogroup LOG
+ * @{
+ */
+
+/**
+ * @brief Current levels of the modules
+ */
+uint8_t logLevels[LOG_MODULE_COUNT] = {
+  [0 ... LOG_MODULE_COUNT - 1] = LOG_DEFAULT_LEVEL,
+};
+
+/**
+ * @brief Module names (message prefixes and :LOG arguments)
+ */
+static const char* const logModuleNames[LOG_MODULE_COUNT] = {
+  "MAIN",
+  "FIFO",
+  "COMM",
+  "LED",
+  "KEYS",
+  "TIMER",
+  "USB_USR",
+  "CMD",
+  "PROTO",
+  "SCHED",
+};
+
+/**
+ * @brief Level names (:LOG arguments)
+ */
+static const char* const logLevelNames[] = {
+  "OFF",
+  "ERROR",
+  "WARN",
+  "INFO",
+  "DEBUG",
+};
+
+#define LOG_ITM_PORT   0           ///< ITM stimulus port of log messages
+#define LOG_RAM_LEN    1024        ///< Length of RAM ring (power of two)
+#define LOG_RAM_MAGIC  0x4C4F4752  ///< Marks valid RAM ring contents ("LOGR")
+
+/**
+ * @brief Log messages kept in RAM over a soft reset.
+ */
+typedef struct {
+  uint32_t magic;             ///< LOG_RAM_MAGIC if contents are valid
+  uint32_t head;              ///< Total number of bytes written
+  uint8_t  buf[LOG_RAM_LEN];  ///< Last LOG_RAM_LEN bytes of messages
+} LOG_Ram_TypeDef;
+
+/**
+ * @brief RAM ring (not zeroed on startup)
+ */
+static LOG_Ram_TypeDef logRam __attribute__((section(".noinit")));
+
+static uint16_t LOG_UartWrite(const uint8_t* data, uint16_t len);
+static uint16_t LOG_ItmWrite(const uint8_t* data, uint16_t len);
+static uint16_t LOG_RamWrite(const uint8_t* data, uint16_t len);
+
+/**
+ * @brief Terminal sink
+ */
+static LOG_Sink_TypeDef logUartSink = {
+  "UART", LOG_DEBUG, LOG_ALL_MODULES, LOG_UartWrite, 0,
+};
+/**
+ * @brief ITM (SWO) sink
+ */
+static LOG_Sink_TypeDef logItmSink = {
+  "ITM", LOG_DEBUG, LOG_ALL_MODULES, LOG_ItmWrite, 0,
+};
+/**
+ * @brief RAM ring sink (warnings and errors for post mortem)
+ */
+static LOG_Sink_TypeDef logRamSink = {
+  "RAM", LOG_WARN, LOG_ALL_MODULES, LOG_RamWrite, 0,
+};
+
+/**
+ * @brief Registered sinks
+ * @details The terminal is registered from the start, so messages
+ * logged before LOG_Init (e.g. by COMM_Init) are not lost.
+ */
+static LOG_Sink_TypeDef* logSinks[LOG_MAX_SINKS] = { &logUartSink };
+static uint8_t logSinkCount = 1; ///< Number of registered sinks
+static volatile uint8_t logItmBusy; ///< Nonzero while a message goes to the ITM
+
+/**
+ * @brief Writes a message to the terminal.
+ * @details The TX FIFO has a single producer (the main loop),
+ * so messages from interrupts are dropped.
+ * @param data Message
+ * @param len Length of message
+ * @return len if message was queued, 0 otherwise
+ */
+static uint16_t LOG_UartWrite(const uint8_t* data, uint16_t len) {
+
+  if (CPU_HAL_InInterrupt() || COMM_TxFree() < len) {
+    return 0;
+  }
+  return COMM_Write(data, len);
+}
+/**
+ * @brief Writes a message to the ITM stimulus port.
+ * @details Interrupts stay enabled while waiting for a slow SWO. A
+ * message logged by an interrupt while another one is being written
+ * is dropped, so messages are never mixed.
+ * @param data Message
+ * @param len Length of message
+ * @return Number of bytes taken
+ */
+static uint16_t LOG_ItmWrite(const uint8_t* data, uint16_t len) {
+
+  uint32_t state = CPU_HAL_EnterCritical(); // port is shared with interrupts
+  uint8_t busy = logItmBusy;
+  logItmBusy = 1;
+  CPU_HAL_ExitCritical(state);
+
+  if (busy) {
+    return 0;
+  }
+
+  len = ITM_HAL_Write(LOG_ITM_PORT, data, len);
+  logItmBusy = 0;
+
+  return len;
+}
+/**
+ * @brief Writes a message to the RAM ring.
+ * @details The oldest data is overwritten, so it always takes
+ * the whole message.
+ * @param data Message
+ * @param len Length of message
+ * @return len
+ */
+static uint16_t LOG_RamWrite(const uint8_t* data, uint16_t len) {
+
+  uint32_t state = CPU_HAL_EnterCritical();
+
+  for (uint16_t i = 0; i < len; i++) {
+    logRam.buf[logRam.head++ & (LOG_RAM_LEN - 1)] = data[i];
+  }
+
+  CPU_HAL_ExitCritical(state);
+
+  return len;
+}
+/**
+ * @brief Prints the contents of the RAM ring to the terminal.
+ * @details Shows the messages logged before the last soft reset
+ * (and after it).
+ */
+static void LOG_RamDump(void) {
+
+  uint32_t head = logRam.head;
+  uint32_t len = head < LOG_RAM_LEN ? head : LOG_RAM_LEN;
+  uint16_t offset = (head - len) & (LOG_RAM_LEN - 1);
+  uint16_t first = LOG_RAM_LEN - offset;
+
+  if (first > len) {
+    first = len;
+  }
+
+  COMM_Printf("LOG--> RAM ring (%u bytes):\r\n", (unsigned)len);
+  COMM_Write(&logRam.buf[offset], first);
+  COMM_Write(logRam.buf, len - first);
+}
+/**
+ * @brief Parses a level given by name or number.
+ * @param token Level
+ * @return Level or -1 if invalid
+ */
+static int8_t LOG_ParseLevel(const CMD_Token_TypeDef* token) {
+
+  for (uint8_t i = 0; i <= LOG_DEBUG; i++) {
+    if (CMD_TokenEquals(token, logLevelNames[i]) ||
+        (token->len == 1 && token->str[0] == '0' + i)) {
+      return i;
+    }
+  }
+  return -1;
+}
+/**
+ * @brief Handles the :LOG command
+ * @details
+ * :LOG - print levels of all modules and sinks
+ * :LOG <module|ALL> <level> - set level of module (name or 0-4)
+ * :LOG SINK <sink> <level> - set level of sink
+ * :LOG DUMP - print RAM ring
+ * @param argc Number of arguments
+ * @param argv Arguments
+ */
+static void LOG_Command(uint8_t argc, const CMD_Token_TypeDef* argv) {
+
+  int8_t level;
+  uint8_t found = 0;
+
+  if (argc == 0) {
+    for (uint8_t i = 0; i < LOG_MODULE_COUNT; i++) {
+      COMM_Printf("LOG--> %-8s %s\r\n", logModuleNames[i],
+          logLevelNames[logLevels[i]]);
+    }
+    for (uint8_t i = 0; i < logSinkCount; i++) {
+      COMM_Printf("LOG--> Sink %-8s %-5s drops %u\r\n", logSinks[i]->name,
+          logLevelNames[logSinks[i]->level], (unsigned)logSinks[i]->drops);
+    }
+    return;
+  }
+
+  if (argc == 1 && CMD_TokenEquals(&argv[0], "DUMP")) {
+    LOG_RamDump();
+    return;
+  }
+
+  level = argc > 1 ? LOG_ParseLevel(&argv[argc - 1]) : -1;
+
+  if (level < 0 || (argc == 3 && !CMD_TokenEquals(&argv[0], "SINK"))) {
+    COMM_Printf("LOG--> Usage: :LOG [DUMP | <module|ALL> <level> | SINK <sink> <level>]\r\n");
+    return;
+  }
+
+  if (argc == 3) {
+    for (uint8_t i = 0; i < logSinkCount; i++) {
+      if (CMD_TokenEquals(&argv[1], logSinks[i]->name)) {
+        logSinks[i]->level = level;
+        return;
+      }
+    }
+    COMM_Printf("LOG--> Unknown sink\r\n");
+    return;
+  }
+
+  for (uint8_t i = 0; i < LOG_MODULE_COUNT; i++) {
+    if (CMD_TokenEquals(&argv[0], "ALL") ||
+        CMD_TokenEquals(&argv[0], logModuleNames[i])) {
+      LOG_SetLevel(i, level);
+      found = 1;
+    }
+  }
+
+  if (!found) {
+    COMM_Printf("LOG--> Unknown module\r\n");
+  }
+}
+/**
+ * @brief Initialize logging.
+ * @details Adds the ITM and RAM ring sinks (the UART sink is always
+ * registered) and registers the :LOG command. The RAM ring keeps its
+ * contents over a soft reset.
+ */
+void LOG_Init(void) {
+
+  if (logRam.magic != LOG_RAM_MAGIC) { // power on - contents are random
+    logRam.magic = LOG_RAM_MAGIC;
+    logRam.head = 0;
+  }
+
+  LOG_AddSink(&logItmSink);
+  LOG_AddSink(&logRamSink);
+
+  CMD_Register(":LOG", LOG_Command, 0, 3);
+}
+/**
+ * @brief Add a sink.
+ * @details For example a USB channel - the write function must
+ * not block.
+ * @param sink Sink with all fields filled in
+ * @retval 0 Sink added
+ * @retval 1 Too many sinks
+ */
+uint8_t LOG_AddSink(LOG_Sink_TypeDef* sink) {
+
+  if (logSinkCount >= LOG_MAX_SINKS) {
+    return 1;
+  }
+  logSinks[logSinkCount++] = sink;
+  return 0;
+}
+/**
+ * @brief Set level of a module.
+ * @param module Module
+ * @param level New level
+ */
+void LOG_SetLevel(LOG_Module_TypeDef module, LOG_Level_TypeDef level) {
+  logLevels[module] = level;
+}
+/**
+ * @brief Checks the rate limit of a call site.
+ * @details Called by LOG_LIMITED - don't call directly. Prints the
+ * number of messages suppressed since the last allowed one.
+ * @param module Module
+ * @param level Level of message
+ * @param limit Limit of call site
+ * @param ms Interval in ms
+ * @retval 1 Message allowed
+ * @retval 0 Message suppressed
+ */
+uint8_t LOG_Allow(LOG_Module_TypeDef module, LOG_Level_TypeDef level,
+    LOG_Limit_TypeDef* limit, uint32_t ms) {
+
+  if (!TIMER_DeadlineExpired(limit->next)) {
+    if (limit->suppressed < UINT16_MAX) {
+      limit->suppressed++;
+    }
+    return 0;
+  }
+
+  if (limit->suppressed) {
+    LOG_Print(module, level, "%u messages suppressed", (unsigned)limit->suppressed);
+    limit->suppressed = 0;
+  }
+
+  limit->next = TIMER_DeadlineAfter(ms);
+
+  return 1;
+}
+/**
+ * @brief Sends a log message to the sinks.
+ * @details Called by the LOG macros - don't call directly. The
+ * message is formatted once on the stack and each sink that
+ * passes it gets the whole line.
+ * @param module Module
+ * @param level Level of message
+ * @param fmt Format string
+ */
+void LOG_Print(LOG_Module_TypeDef module, LOG_Level_TypeDef level,
+    const char* fmt, ...) {
+
+  char line[LOG_LINE_LEN];
+  uint16_t len;
+  va_list args;
+  LOG_Sink_TypeDef* sink;
+
+  len = FORMAT_Snprintf(line, sizeof(line) - 2, "%s--> ", logModuleNames[module]);
+
+  va_start(args, fmt);
+  len += FORMAT_Vsnprintf(&line[len], sizeof(line) - 2 - len, fmt, args);
+  va_end(args);
+
+  line[len++] = '\r';
+  line[len++] = '\n';
+
+  for (uint8_t i = 0; i < logSinkCount; i++) {
+
+    sink = logSinks[i];
+
+    if (level > sink->level || !(sink->modules & (1UL << module))) {
+      continue;
+    }
+
+    if (sink->write((const uint8_t*)line, len) < len) {
+      sink->drops++;
+    }
+  }
+}
+
+/**
+ * @}
+ */
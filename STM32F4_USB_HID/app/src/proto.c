@@ -0,0 +1,281 @@
+/**
+ * @file    proto.c
+ * @brief   Binary command protocol
+ * @date    17 paź 2026
+ * @author  Michal Ksiezopolski
+ *
+ * @verbatim
+ * Copyright (c) 2026 Michal Ksiezopolski.
+ * All rights reserved. This program and the
+ * accompanying materials are made available
+ * under the terms of the GNU Public License
+ * v3.0 which accompanies this distribution,
+ * and is available at
+ * http://www.gnu.org/licenses/gpl.html
+ * @endverbatim
+ */
+
+#include <proto.h>
+#include <log.h>
+#include <comm.h>
+// HAL
+#include <crc_hal.h>
+#include <string.h>
+
+#define LOG_MODULE LOG_PROTO ///< Module of log messages
+
+/**
+ * @addtogroup PROTO
+ * @{
+ */
+
+#define PROTO_BUF_LEN     1024 ///< COMM buffer lengths
+#define PROTO_DELIMITER   0x00 ///< Packet delimiter (never appears in COBS data)
+#define PROTO_MAX_PACKET  (PROTO_HEADER_LEN + PROTO_MAX_PAYLOAD + PROTO_CRC_LEN) ///< Decoded packet length
+#define PROTO_MAX_ENCODED (PROTO_MAX_PACKET + PROTO_MAX_PACKET / 254 + 2) ///< Encoded packet length (with delimiter)
+
+typedef char PROTO_LenCheck[PROTO_MAX_ENCODED <= COMM_MAX_FRAME_LEN ? 1 : -1];
+
+static uint8_t rxBuffer[PROTO_BUF_LEN]; ///< Buffer for received data
+static uint8_t txBuffer[PROTO_BUF_LEN]; ///< Buffer for transmitted data
+
+static COMM_TypeDef link; ///< COMM port carrying the packets
+
+static PROTO_Stats_TypeDef protoStats; ///< Statistics
+
+/**
+ * @brief Callback handling requests
+ */
+static uint8_t (*protoHandler)(uint8_t op, uint8_t seq, const uint8_t* data, uint16_t len);
+
+/**
+ * @brief COBS encode data.
+ * @param src Data
+ * @param len Length of data
+ * @param dst Encoded data (len + len / 254 + 1 bytes)
+ * @return Length of encoded data
+ */
+static uint16_t PROTO_CobsEncode(const uint8_t* src, uint16_t len, uint8_t* dst) {
+
+  uint16_t code = 0; // index of current code byte
+  uint16_t out = 1;
+  uint8_t n = 1;     // code value (distance to next zero)
+
+  while (len--) {
+    if (*src == 0) {
+      dst[code] = n;
+      code = out++;
+      n = 1;
+    } else {
+      dst[out++] = *src;
+      if (++n == 0xFF) { // maximum block length
+        dst[code] = n;
+        code = out++;
+        n = 1;
+      }
+    }
+    src++;
+  }
+  dst[code] = n;
+
+  return out;
+}
+/**
+ * @brief COBS decode data in place.
+ * @param buf Encoded data (replaced by decoded data)
+ * @param len Length of encoded data
+ * @param out Length of decoded data
+ * @retval 0 Data decoded
+ * @retval 1 Invalid encoding
+ */
+static uint8_t PROTO_CobsDecode(uint8_t* buf, uint16_t len, uint16_t* out) {
+
+  uint16_t in = 0;
+  uint16_t n = 0;
+  uint8_t code;
+
+  // output never overtakes input, so decoding in place is safe
+  while (in < len) {
+
+    code = buf[in++];
+
+    if (code == 0 || in + code - 1 > len) {
+      return 1;
+    }
+
+    for (uint8_t k = 1; k < code; k++) {
+      buf[n++] = buf[in++];
+    }
+
+    if (code != 0xFF && in < len) {
+      buf[n++] = 0;
+    }
+  }
+
+  *out = n;
+  return 0;
+}
+/**
+ * @brief Initialize the protocol.
+ * @param port HAL port
+ * @param baud Baud rate
+ * @param handler Callback handling requests. It should reply with
+ * PROTO_Reply and return PROTO_OK or return an error status, which
+ * is then sent as the reply.
+ */
+void PROTO_Init(uint8_t port, uint32_t baud,
+    uint8_t (*handler)(uint8_t op, uint8_t seq, const uint8_t* data, uint16_t len)) {
+
+  protoHandler = handler;
+
+  CRC_HAL_Init();
+
+  link.port       = port;
+  link.baud       = baud;
+  link.rxBuf      = rxBuffer;
+  link.txBuf      = txBuffer;
+  link.bufLen     = PROTO_BUF_LEN;
+  link.terminator = PROTO_DELIMITER;
+  link.binary     = 1; // no text in the COBS stream
+
+  COMM_Add(&link);
+}
+/**
+ * @brief Sets the function called when packets arrive.
+ * @details The function runs in interrupt - it should only signal
+ * the code calling PROTO_Update (see SCHED_Notify).
+ * @param callback Function (NULL - none)
+ * @param ctx Passed to callback
+ */
+void PROTO_SetFrameCallback(void (*callback)(void*), void* ctx) {
+  link.frameCtx = ctx;
+  link.frameCallback = callback;
+}
+/**
+ * @brief Handle all received packets.
+ * @details Call in the main loop.
+ */
+void PROTO_Update(void) {
+
+  uint8_t buf[COMM_MAX_FRAME_LEN + 1];
+  uint16_t len;
+  uint16_t payloadLen;
+  uint32_t crc;
+  uint8_t status;
+  uint8_t ret;
+
+  while ((ret = COMM_PortGetFrame(&link, buf, &len, sizeof(buf))) != 1) {
+
+    if (ret) { // COMM dropped the frame
+      protoStats.frameErrors++;
+      continue;
+    }
+
+    if (len == 0) { // empty frames may be used by host to resync
+      continue;
+    }
+
+    if (PROTO_CobsDecode(buf, len, &len) ||
+        len < PROTO_HEADER_LEN + PROTO_CRC_LEN) {
+      protoStats.frameErrors++;
+      continue;
+    }
+
+    payloadLen = buf[2] | (buf[3] << 8);
+
+    if (payloadLen != len - PROTO_HEADER_LEN - PROTO_CRC_LEN) {
+      protoStats.frameErrors++;
+      continue;
+    }
+
+    crc = buf[len - 4] | (buf[len - 3] << 8) |
+        (buf[len - 2] << 16) | ((uint32_t)buf[len - 1] << 24);
+
+    if (CRC_HAL_Calc(buf, len - PROTO_CRC_LEN) != crc) {
+      protoStats.crcErrors++;
+      continue;
+    }
+
+    protoStats.rxPackets++;
+
+    status = protoHandler(buf[0], buf[1], &buf[PROTO_HEADER_LEN], payloadLen);
+
+    if (status != PROTO_OK) {
+      PROTO_Reply(buf[0], buf[1], &status, 1);
+    }
+  }
+}
+/**
+ * @brief Send a packet.
+ * @param op Opcode
+ * @param seq Sequence number
+ * @param data Payload
+ * @param len Length of payload
+ * @retval 0 Packet sent
+ * @retval 1 Payload too long
+ * @retval 2 No room in TX FIFO (packet dropped)
+ */
+uint8_t PROTO_Send(uint8_t op, uint8_t seq, const uint8_t* data, uint16_t len) {
+
+  uint8_t packet[PROTO_MAX_PACKET];
+  uint8_t encoded[PROTO_MAX_ENCODED];
+  uint32_t crc;
+  uint16_t n;
+
+  if (len > PROTO_MAX_PAYLOAD) {
+    LOG_ERR("Payload too long");
+    return 1;
+  }
+
+  packet[0] = op;
+  packet[1] = seq;
+  packet[2] = len & 0xFF;
+  packet[3] = len >> 8;
+  memcpy(&packet[PROTO_HEADER_LEN], data, len);
+  n = PROTO_HEADER_LEN + len;
+
+  crc = CRC_HAL_Calc(packet, n);
+  packet[n++] = crc & 0xFF;
+  packet[n++] = (crc >> 8) & 0xFF;
+  packet[n++] = (crc >> 16) & 0xFF;
+  packet[n++] = crc >> 24;
+
+  n = PROTO_CobsEncode(packet, n, encoded);
+  encoded[n++] = PROTO_DELIMITER;
+
+  // only whole packets - a cut off one would merge with the next
+  if (COMM_PortTxFree(&link) < n) {
+    protoStats.txDropped++;
+    return 2;
+  }
+
+  COMM_PortWrite(&link, encoded, n);
+
+  protoStats.txPackets++;
+
+  return 0;
+}
+/**
+ * @brief Send a reply to a request.
+ * @param op Opcode of request
+ * @param seq Sequence number of request
+ * @param data Payload
+ * @param len Length of payload
+ * @retval 0 Reply sent
+ * @retval 1 Payload too long
+ * @retval 2 No room in TX FIFO (reply dropped)
+ */
+uint8_t PROTO_Reply(uint8_t op, uint8_t seq, const uint8_t* data, uint16_t len) {
+  return PROTO_Send(op | PROTO_REPLY, seq, data, len);
+}
+/**
+ * @brief Read the protocol statistics.
+ * @param stats Copy of the statistics
+ */
+void PROTO_GetStats(PROTO_Stats_TypeDef* stats) {
+  *stats = protoStats;
+}
+
+/**
+ * @}
+ */
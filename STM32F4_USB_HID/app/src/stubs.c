@@ -20,6 +20,8 @@
 
 
 #include <comm.h>
+#include <errno.h>
+#include <stdint.h>
 
 /**
  * @defgroup  STUBS STUBS
@@ -65,21 +67,35 @@ int _read(int fileHandle, char *buf, int len) {
 }
 
 /**
- *
- * @param fileHandle
- * @param buf
- * @param len
- * @return
- * TODO Expand this function
+ * @brief Writes printf output to the terminal.
+ * @details The whole buffer is queued at once. Newlib retries the
+ * rest after a partial write, a write that makes no progress fails
+ * with EAGAIN (the dropped bytes are reported by COMM).
+ * @param fileHandle File handle (ignored - all output goes to terminal)
+ * @param buf Data
+ * @param len Length of data
+ * @return Number of bytes written or -1 on error
  */
 int _write(int fileHandle, char *buf, int len) {
 
-  int i;
-  for (i=0; i<len; i++) {
-    COMM_Putc((uint8_t)buf[i]);
+  uint16_t n;
+
+  if (len <= 0) {
+    return 0;
+  }
+
+  if (len > UINT16_MAX) { // rest is written in the next call
+    len = UINT16_MAX;
+  }
+
+  n = COMM_Write((uint8_t*)buf, len);
+
+  if (n == 0) {
+    errno = EAGAIN;
+    return -1;
   }
 
-  return len;
+  return n;
 }
 
 /**
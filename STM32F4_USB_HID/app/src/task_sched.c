@@ -0,0 +1,252 @@
+/**
+ * @file    task_sched.c
+ * @brief   Cooperative task scheduler with priorities
+ * @date    17 paź 2026
+ * @author  Michal Ksiezopolski
+ *
+ * @verbatim
+ * Copyright (c) 2026 Michal Ksiezopolski.
+ * All rights reserved. This program and the
+ * accompanying materials are made available
+ * under the terms of the GNU Public License
+ * v3.0 which accompanies this distribution,
+ * and is available at
+ * http://www.gnu.org/licenses/gpl.html
+ * @endverbatim
+ */
+
+#include <task_sched.h>
+#include <log.h>
+#include <cmd.h>
+#include <comm.h>
+#include <timers.h>
+// HAL
+#include <cpu_hal.h>
+
+#define LOG_MODULE LOG_SCHED ///< Module of log messages
+
+/**
+ * @addtogroup SCHED
+ * @{
+ */
+
+/**
+ * @brief Task structure.
+ */
+typedef struct {
+  const char* name;               ///< Name for :TASKS
+  void (*fun)(void*, uint32_t);   ///< Task function
+  void* ctx;                      ///< Passed to fun
+  volatile uint32_t events;       ///< Pending events
+  uint8_t priority;               ///< Priority (0 - highest)
+  SCHED_Stats_TypeDef stats;      ///< Runtime statistics
+} SCHED_Task_TypeDef;
+
+static SCHED_Task_TypeDef tasks[SCHED_MAX_TASKS]; ///< Tasks in order of adding
+static uint8_t taskOrder[SCHED_MAX_TASKS];        ///< Task IDs sorted by priority
+static uint8_t taskCount;                         ///< Number of tasks
+static uint8_t schedBusy;       ///< Nonzero while a task or timer runs
+static uint64_t schedStartTime; ///< Time of SCHED_Init (for CPU load)
+
+/**
+ * @brief Handles the :TASKS command.
+ * @details Prints the runtime statistics of all tasks.
+ * @param argc Number of arguments
+ * @param argv Arguments
+ */
+static void SCHED_Command(uint8_t argc, const CMD_Token_TypeDef* argv) {
+
+  uint32_t cyclesPerUs = TIMER_GetCyclesFreq() / 1000000;
+  uint64_t elapsedUs = (TIMER_Now64() - schedStartTime) * 1000;
+  const SCHED_Task_TypeDef* task;
+  uint32_t load; // in 0.1%
+
+  if (cyclesPerUs == 0 || elapsedUs == 0) {
+    return;
+  }
+
+  for (uint8_t i = 0; i < taskCount; i++) {
+
+    task = &tasks[taskOrder[i]];
+    load = task->stats.totalCycles / cyclesPerUs * 1000 / elapsedUs;
+
+    COMM_Printf("SCHED--> %-8s prio %u runs %u max %u us load %u.%u%%\r\n",
+        task->name, (unsigned)task->priority, (unsigned)task->stats.runs,
+        (unsigned)(task->stats.maxCycles / cyclesPerUs),
+        (unsigned)(load / 10), (unsigned)(load % 10));
+  }
+}
+/**
+ * @brief Initialize the scheduler.
+ * @details Registers the :TASKS command. Call after TIMER_Init.
+ */
+void SCHED_Init(void) {
+
+  schedStartTime = TIMER_Now64();
+
+  CMD_Register(":TASKS", SCHED_Command, 0, 0);
+}
+/**
+ * @brief Adds a task.
+ * @details Tasks are added at startup - they can't be removed.
+ * @param name Task name
+ * @param priority Task priority (0 - highest)
+ * @param fun Task function (gets ctx and the events posted since
+ * its last run)
+ * @param ctx User context passed to fun
+ * @return Returns the ID of the new task or error code (-1)
+ * @retval -1 Error: too many tasks
+ */
+int8_t SCHED_AddTask(const char* name, uint8_t priority,
+    void (*fun)(void*, uint32_t), void* ctx) {
+
+  uint8_t id = taskCount;
+  uint8_t pos;
+
+  if (taskCount >= SCHED_MAX_TASKS) {
+    LOG_ERR("Reached maximum number of tasks!");
+    return -1;
+  }
+
+  tasks[id].name = name;
+  tasks[id].fun = fun;
+  tasks[id].ctx = ctx;
+  tasks[id].events = 0;
+  tasks[id].priority = priority;
+
+  // insert after tasks with the same or higher priority
+  for (pos = taskCount; pos > 0; pos--) {
+    if (tasks[taskOrder[pos - 1]].priority <= priority) {
+      break;
+    }
+    taskOrder[pos] = taskOrder[pos - 1];
+  }
+  taskOrder[pos] = id;
+
+  taskCount++;
+
+  return id;
+}
+/**
+ * @brief Posts events to a task.
+ * @details Can be called from interrupts. Events are bits - posting
+ * an event which is already pending has no effect.
+ * @param id Task ID
+ * @param events Events to set
+ */
+void SCHED_Post(uint8_t id, uint32_t events) {
+
+  if (id >= taskCount) {
+    return;
+  }
+
+  uint32_t state = CPU_HAL_EnterCritical();
+  tasks[id].events |= events;
+  CPU_HAL_ExitCritical(state);
+}
+/**
+ * @brief Posts SCHED_EVENT_NOTIFY to a task.
+ * @details Can be used as a soft timer or COMM frame callback.
+ * @param ctx Task ID made with SCHED_NOTIFY_CTX
+ */
+void SCHED_Notify(void* ctx) {
+  SCHED_Post((uintptr_t)ctx, SCHED_EVENT_NOTIFY);
+}
+/**
+ * @brief Runs the ready task with the highest priority.
+ * @retval 0 No task was ready
+ * @retval 1 A task was run
+ */
+static uint8_t SCHED_RunOne(void) {
+
+  SCHED_Task_TypeDef* task;
+  uint32_t events;
+  uint32_t start;
+  uint32_t cycles;
+  uint32_t state;
+
+  for (uint8_t i = 0; i < taskCount; i++) {
+
+    task = &tasks[taskOrder[i]];
+
+    if (task->events == 0) {
+      continue;
+    }
+
+    // take the events, new ones will run the task again
+    state = CPU_HAL_EnterCritical();
+    events = task->events;
+    task->events = 0;
+    CPU_HAL_ExitCritical(state);
+
+    start = TIMER_GetCycles();
+    task->fun(task->ctx, events);
+    cycles = TIMER_GetCycles() - start;
+
+    task->stats.runs++;
+    task->stats.totalCycles += cycles;
+    if (cycles > task->stats.maxCycles) {
+      task->stats.maxCycles = cycles;
+    }
+
+    return 1;
+  }
+
+  return 0;
+}
+/**
+ * @brief Updates the soft timers and runs one task.
+ * @details Does nothing when called from a task or a timer callback,
+ * so it can be used as an idle hook of blocking functions (see
+ * USB_OTG_BSP_SetIdleHook).
+ */
+void SCHED_Poll(void) {
+
+  if (schedBusy) {
+    return;
+  }
+
+  schedBusy = 1;
+  TIMER_SoftTimersUpdate(); // timers post events
+  SCHED_RunOne();
+  schedBusy = 0;
+}
+/**
+ * @brief Runs the tasks forever.
+ * @details After every task the highest priority ready task is
+ * picked again. When no task is ready, the core sleeps until the
+ * next soft timer or interrupt.
+ */
+void SCHED_Run(void) {
+
+  uint8_t ran;
+
+  while (1) {
+
+    schedBusy = 1;
+    TIMER_SoftTimersUpdate(); // timers post events
+    ran = SCHED_RunOne();
+    schedBusy = 0;
+
+    if (!ran) {
+      TIMER_Idle(); // sleep until next timer or interrupt
+    }
+  }
+}
+/**
+ * @brief Gets the runtime statistics of a task.
+ * @param id Task ID
+ * @param stats Statistics
+ */
+void SCHED_GetStats(uint8_t id, SCHED_Stats_TypeDef* stats) {
+
+  if (id >= taskCount) {
+    return;
+  }
+
+  *stats = tasks[id].stats;
+}
+
+/**
+ * @}
+ */
@@ -20,63 +20,181 @@
  */
 
 #include <timers.h>
-#include <stdio.h>
+#include <log.h>
+#include <stddef.h>
 #include <systick.h>
-#include <timer14.h>
+#include <timer5.h>
 
-#ifndef DEBUG
-  #define DEBUG
-#endif
-
-#ifdef DEBUG
-  #define print(str, args...) printf("LED--> "str"%s",##args,"\r")
-  #define println(str, args...) printf("LED--> "str"%s",##args,"\r\n")
-#else
-  #define print(str, args...) (void)0
-  #define println(str, args...) (void)0
-#endif
+#define LOG_MODULE LOG_TIMER ///< Module of log messages
 
 /**
  * @addtogroup TIMER
  * @{
  */
 
-#define MAX_SOFT_TIMERS 10 ///< Maximum number of soft timers.
+#ifndef MAX_SOFT_TIMERS
+  #define MAX_SOFT_TIMERS 32 ///< Maximum number of soft timers.
+#endif
+
+#ifndef TIMER_WHEEL_SIZE
+  #define TIMER_WHEEL_SIZE 64 ///< Number of timer wheel slots (power of two).
+#endif
+
+#ifndef TIMER_TICKLESS
+  #define TIMER_TICKLESS 1 ///< Suppress SysTick while idle (0 - wake every tick)
+#endif
 
-static uint8_t softTimerCount; ///< Count number of soft timers
+#define TIMER_NONE 0xFFFF ///< End of slot list
+
+typedef char TIMER_WheelCheck[(TIMER_WHEEL_SIZE & (TIMER_WHEEL_SIZE - 1)) == 0 ? 1 : -1];
+
+/**
+ * @brief Soft timer state.
+ */
+typedef enum {
+  TIMER_FREE,     ///< Not used (in free list)
+  TIMER_STOPPED,  ///< Not in the wheel
+  TIMER_RUNNING,  ///< Waiting in the wheel
+  TIMER_PAUSED,   ///< Not in the wheel, remaining time stored
+} TIMER_State_TypeDef;
+
+static uint16_t freeTimers; ///< First unused timer (linked through next)
 
 /**
  * @brief Soft timer structure.
  */
 typedef struct {
-  uint8_t id;                     ///< Timer ID
-  uint32_t value;                 ///< Current count value
+  uint64_t expiry;                ///< System time of next overflow (or remaining time if paused)
   uint32_t max;                   ///< Overflow value
-  uint8_t active;                 ///< Is timer active?
-  void (*overflowCallback)(void); ///< Function called on overflow event
+  uint16_t next;                  ///< Next timer in wheel slot (or free list)
+  uint16_t prev;                  ///< Previous timer in wheel slot
+  uint8_t state;                  ///< State of timer
+  uint8_t mode;                   ///< Periodic or one shot
+  void (*overflowCallback)(void*); ///< Function called on overflow event
+  void* ctx;                      ///< Passed to overflowCallback
 } TIMER_Soft_TypeDef;
 
 static TIMER_Soft_TypeDef softTimers[MAX_SOFT_TIMERS]; ///< Array of soft timers
 
+/**
+ * @brief Timer wheel.
+ * @details Every slot holds the timers whose overflow time modulo
+ * TIMER_WHEEL_SIZE equals the slot number. Every tick only one slot
+ * is checked, so the cost doesn't depend on the number of timers
+ * (as long as there are not many more timers than slots).
+ */
+static uint16_t timerWheel[TIMER_WHEEL_SIZE];
+static uint64_t wheelTime; ///< Last tick processed by TIMER_SoftTimersUpdate
+
+/**
+ * @brief Puts a timer in its wheel slot.
+ * @param id Timer ID
+ */
+static void TIMER_Link(uint16_t id) {
+
+  uint16_t* head = &timerWheel[softTimers[id].expiry & (TIMER_WHEEL_SIZE - 1)];
+
+  softTimers[id].prev = TIMER_NONE;
+  softTimers[id].next = *head;
+  if (*head != TIMER_NONE) {
+    softTimers[*head].prev = id;
+  }
+  *head = id;
+}
+/**
+ * @brief Removes a timer from its wheel slot.
+ * @param id Timer ID
+ */
+static void TIMER_Unlink(uint16_t id) {
+
+  TIMER_Soft_TypeDef* timer = &softTimers[id];
+
+  if (timer->prev != TIMER_NONE) {
+    softTimers[timer->prev].next = timer->next;
+  } else {
+    timerWheel[timer->expiry & (TIMER_WHEEL_SIZE - 1)] = timer->next;
+  }
+  if (timer->next != TIMER_NONE) {
+    softTimers[timer->next].prev = timer->prev;
+  }
+}
+/**
+ * @brief Schedules a timer to overflow after a given time.
+ * @param id Timer ID
+ * @param ms Time to overflow
+ */
+static void TIMER_Schedule(uint16_t id, uint32_t ms) {
+
+  if (ms == 0) { // overflow on the next tick at the earliest
+    ms = 1;
+  }
+  if (softTimers[id].max == 0) { // periodic timer needs a period
+    softTimers[id].max = 1;
+  }
+  softTimers[id].expiry = SYSTICK_GetTime64() + ms;
+  softTimers[id].state = TIMER_RUNNING;
+  TIMER_Link(id);
+}
+
 /**
  * @brief Initiate the system time interrupt with a given frequency.
  * @param freq Required frequency of the timer in Hz
  */
 void TIMER_Init(uint32_t freq) {
 
-  SYSTICK_Init(freq); // initialize sysTick for ms count
+  for (uint16_t i = 0; i < TIMER_WHEEL_SIZE; i++) {
+    timerWheel[i] = TIMER_NONE;
+  }
 
-  // initialize TIMER14 as microsecond counter
-//  TIMER14_Init();
+  // all timers are free
+  for (uint16_t i = 0; i < MAX_SOFT_TIMERS; i++) {
+    softTimers[i].state = TIMER_FREE;
+    softTimers[i].next = i + 1 < MAX_SOFT_TIMERS ? i + 1 : TIMER_NONE;
+  }
+  freeTimers = 0;
+
+  TIMER5_Init(); // high resolution time base (measures SysTick sleeps)
+
+  SYSTICK_Init(freq); // initialize sysTick for ms count
+  wheelTime = SYSTICK_GetTime64();
 
 }
 /**
  * @brief Returns the system time.
+ * @details Lower 32 bits of TIMER_Now64 - overflows every 49 days.
+ * Use it for timestamps only, deadlines should be 64 bit.
  * @return System time
  */
 uint32_t TIMER_GetTime(void) {
   return SYSTICK_GetTime();
 }
+/**
+ * @brief Returns the 64 bit system time.
+ * @details Never overflows, can be read from any context.
+ * @return System time in ms
+ */
+uint64_t TIMER_Now64(void) {
+  return SYSTICK_GetTime64();
+}
+/**
+ * @brief Computes a deadline.
+ * @details The current tick has already partly passed, so one tick is
+ * added - at least ms milliseconds pass before the deadline expires.
+ * @param ms Time to deadline
+ * @return Deadline for TIMER_DeadlineExpired
+ */
+uint64_t TIMER_DeadlineAfter(uint32_t ms) {
+  return TIMER_Now64() + ms + 1;
+}
+/**
+ * @brief Checks if a deadline has passed.
+ * @param deadline Deadline from TIMER_DeadlineAfter (0 - always expired)
+ * @retval 0 Deadline has not been reached (wait longer)
+ * @retval 1 Deadline has been reached
+ */
+uint8_t TIMER_DeadlineExpired(uint64_t deadline) {
+  return TIMER_Now64() >= deadline;
+}
 
 /**
  * @brief Delay function.
@@ -85,18 +203,10 @@ uint32_t TIMER_GetTime(void) {
  */
 void TIMER_Delay(uint32_t ms) {
 
-  uint32_t startTime = TIMER_GetTime();
-  uint32_t currentTime;
+  uint64_t deadline = TIMER_DeadlineAfter(ms);
 
-  while (1) { // Delay
-    currentTime = TIMER_GetTime();
-    if ((currentTime >= startTime) && (currentTime-startTime > ms)) {
-      break;
-    }
-    // account for system timer overflow
-    if ((currentTime < startTime) && (UINT32_MAX-startTime + currentTime > ms)) {
-      break;
-    }
+  while (!TIMER_DeadlineExpired(deadline)) {
+    // Delay
   }
 }
 
@@ -106,138 +216,267 @@ void TIMER_Delay(uint32_t ms) {
  * @warning This is a blocking function. Use with care!
  */
 void TIMER_DelayUS(uint32_t us) {
+  TIMER5_DelayUS(us);
+}
+/**
+ * @brief Returns the high resolution time.
+ * @details Ticks of a free running 32 bit counter (84 MHz with the
+ * default clocks). Use for measuring short intervals - differences
+ * are correct across overflow for intervals below 51 s.
+ * @return Time in counter ticks
+ */
+uint32_t TIMER_GetCycles(void) {
+  return TIMER5_GetTime();
+}
+/**
+ * @brief Returns the frequency of the high resolution time.
+ * @return TIMER_GetCycles ticks per second
+ */
+uint32_t TIMER_GetCyclesFreq(void) {
+  return TIMER5_GetFreq();
+}
+/**
+ * @brief Converts high resolution ticks to nanoseconds.
+ * @param cycles Number of ticks (difference of TIMER_GetCycles values)
+ * @return Time in ns (saturated at UINT32_MAX)
+ */
+uint32_t TIMER_CyclesToNs(uint32_t cycles) {
 
-  uint32_t startTime = TIMER14_GetTime();
-  uint32_t currentTime;
+  uint64_t ns = (uint64_t)cycles * 1000000000 / TIMER5_GetFreq();
 
-  while (1) { // Delay
-    currentTime = TIMER14_GetTime();
-    if ((currentTime >= startTime) && (currentTime-startTime > us)) {
-      break;
-    }
-    // account for system timer overflow
-    if ((currentTime < startTime) && (UINT32_MAX-startTime + currentTime > us)) {
-      break;
-    }
-  }
+  return ns > UINT32_MAX ? UINT32_MAX : ns;
 }
 
 /**
- * @brief Nonblocking delay function using
- * @param ms Delay time
- * @param startTime System time at start of delay (this has to be written before delay using TIMER_GetTime())
- * @retval 0 Delay value has not been reached (wait longer)
- * @retval 1 Delay value has been reached
+ * @brief Adds a soft timer
+ * @details The timer is stopped - start it with TIMER_StartSoftTimer.
+ * @param maxVal Overflow value of timer (period)
+ * @param mode TIMER_PERIODIC or TIMER_ONE_SHOT
+ * @param fun Function called on overflow (gets ctx)
+ * @param ctx User context passed to fun
+ * @return Returns the ID of the new counter or error code (-1)
+ * @retval -1 Error: too many timers
  */
-uint8_t TIMER_DelayTimer(uint32_t ms, uint32_t startTime) {
+int16_t TIMER_AddSoftTimer(uint32_t maxVal, TIMER_Mode_TypeDef mode,
+    void (*fun)(void*), void* ctx) {
 
-  uint32_t currentTime = TIMER_GetTime();
+  uint16_t id = freeTimers;
 
-  if ((currentTime >= startTime) && (currentTime-startTime > ms)) {
+  if (id == TIMER_NONE) {
+    LOG_ERR("Reached maximum number of timers!");
+    return -1;
+  }
 
-    return 1;
+  freeTimers = softTimers[id].next;
 
-  // account for system timer overflow
-  } else if ((currentTime < startTime) && (UINT32_MAX-startTime + currentTime > ms)) {
-    return 1;
-  } else {
-    return 0;
-  }
+  softTimers[id].overflowCallback = fun;
+  softTimers[id].ctx = ctx;
+  softTimers[id].max = maxVal;
+  softTimers[id].mode = mode;
+  softTimers[id].state = TIMER_STOPPED; // inactive on startup
 
+  return id;
 }
-
 /**
- * @brief Adds a soft timer
- * @param maxVal Overflow value of timer
- * @param fun Function called on overflow (should return void and accept no parameters)
- * @return Returns the ID of the new counter or error code (-1)
- * @retval -1 Error: too many timers
+ * @brief Deletes a soft timer.
+ * @details The ID can be returned by TIMER_AddSoftTimer again. Can
+ * be called from the overflow function of the deleted timer.
+ * @param id Timer ID
  */
-int8_t TIMER_AddSoftTimer(uint32_t maxVal, void (*fun)(void)) {
+void TIMER_DeleteSoftTimer(uint16_t id) {
 
-  if (softTimerCount > MAX_SOFT_TIMERS) {
-    println("TIMERS: Reached maximum number of timers!");
-    return -1;
+  if (id >= MAX_SOFT_TIMERS || softTimers[id].state == TIMER_FREE) {
+    return;
   }
 
-  softTimers[softTimerCount].id = softTimerCount;
-  softTimers[softTimerCount].overflowCallback = fun;
-  softTimers[softTimerCount].max = maxVal;
-  softTimers[softTimerCount].value = 0;
-  softTimers[softTimerCount].active = 0; // inactive on startup
+  if (softTimers[id].state == TIMER_RUNNING) {
+    TIMER_Unlink(id);
+  }
 
-  softTimerCount++;
+  softTimers[id].state = TIMER_FREE;
+  softTimers[id].next = freeTimers;
+  freeTimers = id;
+}
+/**
+ * @brief Stops a timer.
+ * @details TIMER_StartSoftTimer starts it again from zero.
+ * @param id Timer ID
+ */
+void TIMER_StopSoftTimer(uint16_t id) {
 
-  return (softTimerCount - 1);
+  if (id >= MAX_SOFT_TIMERS) {
+    return;
+  }
+  if (softTimers[id].state == TIMER_RUNNING) {
+    TIMER_Unlink(id);
+  }
+  if (softTimers[id].state != TIMER_FREE) {
+    softTimers[id].state = TIMER_STOPPED;
+  }
 }
 
 /**
  * @brief Starts the timer (zeroes out current count value).
  * @param id Timer ID
  */
-void TIMER_StartSoftTimer(uint8_t id) {
+void TIMER_StartSoftTimer(uint16_t id) {
 
-  softTimers[id].value = 0;
-  softTimers[id].active = 1; // start timer
+  if (id >= MAX_SOFT_TIMERS || softTimers[id].state == TIMER_FREE) {
+    return;
+  }
+  if (softTimers[id].state == TIMER_RUNNING) {
+    TIMER_Unlink(id);
+  }
+  TIMER_Schedule(id, softTimers[id].max); // start timer
 }
 /**
  * @brief Pauses given timer (current count value unchanged)
  * @param id Timer ID
  */
-void TIMER_PauseSoftTimer(uint8_t id) {
+void TIMER_PauseSoftTimer(uint16_t id) {
 
-  softTimers[id].active = 0; // pause timer
+  if (id >= MAX_SOFT_TIMERS || softTimers[id].state != TIMER_RUNNING) {
+    return;
+  }
+
+  uint64_t now = SYSTICK_GetTime64();
+
+  TIMER_Unlink(id);
+  // store remaining time - a timer already due (slot not processed
+  // yet) overflows right after resume
+  if (softTimers[id].expiry > now) {
+    softTimers[id].expiry -= now;
+  } else {
+    softTimers[id].expiry = 0;
+  }
+  softTimers[id].state = TIMER_PAUSED; // pause timer
 }
 /**
  * @brief Resumes a timer (starts counting from last value).
  * @param id Timer ID
  */
-void TIMER_ResumeSoftTimer(uint8_t id) {
+void TIMER_ResumeSoftTimer(uint16_t id) {
+
+  if (id >= MAX_SOFT_TIMERS || softTimers[id].state != TIMER_PAUSED) {
+    return;
+  }
 
-  softTimers[id].active = 1; // start timer
+  TIMER_Schedule(id, softTimers[id].expiry); // start timer
+}
+/**
+ * @brief Calls the overflow functions of all timers due in one slot.
+ * @param tick System time of slot
+ */
+static void TIMER_ProcessSlot(uint64_t tick) {
+
+  uint16_t* head = &timerWheel[tick & (TIMER_WHEEL_SIZE - 1)];
+  uint16_t id = *head;
+  TIMER_Soft_TypeDef* timer;
+
+  while (id != TIMER_NONE) {
+
+    timer = &softTimers[id];
+
+    // the slot also holds timers due in later rounds of the wheel
+    if (timer->expiry > tick) {
+      id = timer->next;
+      continue;
+    }
+
+    TIMER_Unlink(id);
+
+    if (timer->mode == TIMER_PERIODIC) {
+      // Next overflow is counted from this one, not from now, so
+      // late updates don't accumulate. If whole periods were
+      // missed they are skipped, keeping the phase.
+      timer->expiry += timer->max;
+      if (timer->expiry <= tick) {
+        timer->expiry += ((tick - timer->expiry) / timer->max + 1) * timer->max;
+      }
+      TIMER_Link(id);
+    } else {
+      timer->state = TIMER_STOPPED;
+    }
+
+    if (timer->overflowCallback != NULL) {
+      timer->overflowCallback(timer->ctx); // call the overflow function
+    }
+
+    // the callback may have changed the slot - start over
+    id = *head;
+  }
 }
 /**
  * @brief Updates all the timers and calls the overflow functions as
  * necessary
  *
  * @details This function should be called periodically in the main
- * loop of the program.
+ * loop of the program. Only the wheel slots of the ticks that passed
+ * since the last call are checked.
  */
 void TIMER_SoftTimersUpdate(void) {
 
-  static uint32_t prevVal;
-  uint32_t delta;
-  uint32_t sysTicks = SYSTICK_GetTime();
+  uint64_t sysTicks = SYSTICK_GetTime64();
 
-  if (sysTicks >= prevVal) {
+  // after a long break every slot is checked once
+  if (sysTicks - wheelTime > TIMER_WHEEL_SIZE) {
+    wheelTime = sysTicks - TIMER_WHEEL_SIZE;
+  }
 
-    delta = sysTicks - prevVal; // How much time passed from previous run
+  while (wheelTime != sysTicks) {
+    wheelTime++;
+    TIMER_ProcessSlot(wheelTime);
+  }
+}
 
-  } else { // if overflow occurs
+/**
+ * @brief Sleeps until the next timer overflow or an interrupt.
+ *
+ * @details Call at the end of the main loop, after all work is done.
+ * Returns at once if any timer is already due. Otherwise the core
+ * sleeps and SysTick interrupts are suppressed until the nearest
+ * overflow. Any other interrupt (USB, UART...) ends the sleep early.
+ * The system time is corrected on wake up, so the timers keep their
+ * accuracy. The nearest overflow is found by walking the wheel slots
+ * from the current tick - usually only a few slots are checked.
+ */
+void TIMER_Idle(void) {
 
-    // the difference is the value that prevVal
-    // has to UINT32_MAX + the new number of sysTicks
-    delta = UINT32_MAX - prevVal + sysTicks;
+  uint64_t now = SYSTICK_GetTime64();
+  uint64_t sleep = UINT32_MAX;
 
+  if (wheelTime != now) { // ticks not processed yet
+    return;
   }
 
-  prevVal += delta; // update time for the function
+#if TIMER_TICKLESS
+  uint16_t id;
 
-  uint8_t i;
-  for (i = 0; i < softTimerCount; i++) {
+  for (uint16_t i = 1; i <= TIMER_WHEEL_SIZE; i++) {
 
-    if (softTimers[i].active == 1) {
+    id = timerWheel[(now + i) & (TIMER_WHEEL_SIZE - 1)];
 
-      softTimers[i].value += delta; // update active timer values
-
-      if (softTimers[i].value >= softTimers[i].max) { // if overflow
-        softTimers[i].value = 0; // zero out timer
-        if (softTimers[i].overflowCallback != NULL) {
-          softTimers[i].overflowCallback(); // call the overflow function
-        }
+    // timers in slot i overflow after i ticks or in later rounds
+    while (id != TIMER_NONE) {
+      if (softTimers[id].expiry <= now) {
+        return;
+      }
+      if (softTimers[id].expiry - now < sleep) {
+        sleep = softTimers[id].expiry - now;
       }
+      id = softTimers[id].next;
+    }
+
+    // later slots can't hold an earlier overflow
+    if (sleep <= i) {
+      break;
     }
   }
+#else
+  sleep = 1; // wake up on every tick
+#endif
+
+  SYSTICK_Sleep(sleep);
 }
 
 /**
@@ -0,0 +1,171 @@
+/**
+ * @file    trace.c
+ * @brief   Deferred binary trace
+ * @date    17 paź 2026
+ * @author  Michal Ksiezopolski
+ *
+ * @verbatim
+ * Copyright (c) 2026 Michal Ksiezopolski.
+ * All rights reserved. This program and the
+ * accompanying materials are made available
+ * under the terms of the GNU Public License
+ * v3.0 which accompanies this distribution,
+ * and is available at
+ * http://www.gnu.org/licenses/gpl.html
+ * @endverbatim
+ */
+
+#include <trace.h>
+#include <fifo.h>
+#include <comm.h>
+#include <timers.h>
+// HAL
+#include <cpu_hal.h>
+#include <stdarg.h>
+
+/**
+ * @addtogroup TRACE
+ * @{
+ */
+
+#define TRACE_BUF_LEN     1024 ///< Length of record ring
+#define TRACE_HEADER_LEN  7    ///< Sync, ID and timestamp
+#define TRACE_MAX_RECORD  (TRACE_HEADER_LEN + 4 * TRACE_MAX_ARGS) ///< Longest record
+
+static uint8_t traceBuffer[TRACE_BUF_LEN]; ///< Buffer for records
+static FIFO_TypeDef traceFifo;             ///< Records waiting for TRACE_Update
+static volatile uint32_t traceDropped;     ///< Records lost because ring was full
+static uint16_t traceRest;                 ///< Bytes of the record being sent
+
+/**
+ * @brief Initialize the trace.
+ */
+void TRACE_Init(void) {
+
+  traceFifo.buf = traceBuffer;
+  traceFifo.len = TRACE_BUF_LEN;
+  FIFO_Add(&traceFifo);
+}
+/**
+ * @brief Stores a trace record.
+ * @details Called by the TRACE macro - don't call directly. Can
+ * be called from interrupts: the record is stored with interrupts
+ * disabled, which takes only a copy of a few bytes.
+ * @param id Format ID
+ * @param argc Number of arguments
+ */
+void TRACE_Record(uint16_t id, uint8_t argc, ...) {
+
+  uint8_t record[TRACE_MAX_RECORD];
+  uint32_t time = TIMER_GetTime();
+  uint32_t arg;
+  uint8_t len = 0;
+  uint32_t state;
+  va_list args;
+
+  record[len++] = TRACE_SYNC + argc;
+  record[len++] = id & 0xFF;
+  record[len++] = id >> 8;
+  record[len++] = time & 0xFF;
+  record[len++] = (time >> 8) & 0xFF;
+  record[len++] = (time >> 16) & 0xFF;
+  record[len++] = time >> 24;
+
+  va_start(args, argc);
+  while (argc--) {
+    arg = va_arg(args, uint32_t);
+    record[len++] = arg & 0xFF;
+    record[len++] = (arg >> 8) & 0xFF;
+    record[len++] = (arg >> 16) & 0xFF;
+    record[len++] = arg >> 24;
+  }
+  va_end(args);
+
+  // several producers (main loop and interrupts) - whole records only
+  state = CPU_HAL_EnterCritical();
+  if (traceFifo.len - FIFO_Count(&traceFifo) >= len) {
+    FIFO_PushBlock(&traceFifo, record, len);
+  } else {
+    traceDropped++;
+  }
+  CPU_HAL_ExitCritical(state);
+}
+/**
+ * @brief Prints a trace message as text.
+ * @details Called by the TRACE macro when TRACE_BINARY is 0 - don't
+ * call directly. The TX FIFO has a single producer (the main loop),
+ * so messages from interrupts are only counted as dropped.
+ * @param fmt Format string
+ */
+void TRACE_Print(const char* fmt, ...) {
+
+  va_list args;
+  uint32_t state;
+
+  if (CPU_HAL_InInterrupt()) {
+    state = CPU_HAL_EnterCritical(); // interrupts can be nested
+    traceDropped++;
+    CPU_HAL_ExitCritical(state);
+    return;
+  }
+
+  va_start(args, fmt);
+  COMM_Vprintf(fmt, args);
+  va_end(args);
+}
+/**
+ * @brief Sends stored records to the terminal.
+ * @details Call in the main loop. Records the terminal can't take
+ * right now stay in the ring. Records are sent whole - if the terminal
+ * takes only part of one, the rest is sent first next time, so the
+ * ring never gets out of step with the records.
+ */
+void TRACE_Update(void) {
+
+  uint8_t* data;
+  uint16_t part;
+  uint16_t sent;
+  uint32_t dropped;
+  uint32_t state;
+
+  while (traceRest || FIFO_Peek(&traceFifo, &data) != 0) {
+
+    if (traceRest == 0) {
+      traceRest = TRACE_HEADER_LEN + 4 * (data[0] - TRACE_SYNC);
+    }
+
+    // Only whole records - other terminal output must not land
+    // inside a record or the decoder loses sync. The free space
+    // includes a pending drop report.
+    if (COMM_TxFree() < traceRest) { // terminal busy
+      break;
+    }
+
+    // the record may wrap around the end of the ring
+    do {
+      part = FIFO_Peek(&traceFifo, &data);
+      if (part > traceRest) {
+        part = traceRest;
+      }
+      sent = COMM_Write(data, part);
+      FIFO_Consume(&traceFifo, sent);
+      traceRest -= sent;
+    } while (traceRest && sent == part);
+
+    if (traceRest) { // terminal full - the rest goes next time
+      break;
+    }
+  }
+
+  if (traceDropped) {
+    state = CPU_HAL_EnterCritical();
+    dropped = traceDropped;
+    traceDropped = 0;
+    CPU_HAL_ExitCritical(state);
+    TRACE("%u trace records dropped", (unsigned)dropped);
+  }
+}
+
+/**
+ * @}
+ */
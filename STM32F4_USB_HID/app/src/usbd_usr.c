@@ -17,17 +17,10 @@
  */
 
 #include <usbd_usr.h>
-#include <stdio.h>
+#include <log.h>
+#include <trace.h>
 
-#define DEBUG
-
-#ifdef DEBUG
-#define print(str, args...) printf(""str"%s",##args,"")
-#define println(str, args...) printf("USB_USR--> "str"%s",##args,"\r\n")
-#else
-#define print(str, args...) (void)0
-#define println(str, args...) (void)0
-#endif
+#define LOG_MODULE LOG_USB ///< Module of log messages
 
 /**
  * @brief User callbacks for USB events
@@ -46,42 +39,42 @@ USBD_Usr_cb_TypeDef USR_cb = {
  */
 void USBD_USR_Init(void) {
 
-  println("USR Init");
+  TRACE("USR Init");
 }
 /**
  *
  * @param speed
  */
 void USBD_USR_DeviceReset(uint8_t speed) {
-  println("Device reset");
+  TRACE("Device reset");
 }
 /**
  *
  */
 void USBD_USR_DeviceConfigured (void) {
-  println("Device configured");
+  TRACE("Device configured");
 }
 /**
  *
  */
 void USBD_USR_DeviceSuspended(void) {
-  println("Device suspended");
+  TRACE("Device suspended");
 }
 /**
  *
  */
 void USBD_USR_DeviceResumed(void) {
-  println("Device resumed");
+  TRACE("Device resumed");
 }
 /**
  *
  */
 void USBD_USR_DeviceConnected (void) {
-  println("Device connected");
+  TRACE("Device connected");
 }
 /**
  *
  */
 void USBD_USR_DeviceDisconnected (void) {
-  println("Device disconnected");
+  TRACE("Device disconnected");
 }
@@ -16,7 +16,7 @@
  */
 
 #include <utils.h>
-#include <stdio.h>
+#include <comm.h>
 #include <timers.h>
 
 /**
@@ -71,19 +71,19 @@ void hexdump(const uint8_t const *buf, uint32_t length) {
 
   while (length--) {
 
-    printf("%02x ", buf[i]);
+    COMM_Printf("%02x ", buf[i]);
 
     i++;
     // new line every 16 chars
     if ((i % 16) == 0) {
-      printf("\r\n");
+      COMM_Printf("\r\n");
     }
     // delay every 50 chars
     if ((i % 50) == 0) {
 //      TIMER_Delay(100); // Delay so as not to overflow buffer
     }
   }
-  printf("\r\n");
+  COMM_Printf("\r\n");
 }
 
 /**
@@ -99,22 +99,22 @@ void hexdumpC(const uint8_t const *buf, uint32_t length) {
   while (length--) {
 
     if (buf[i]>=' ' && buf[i] <= '~') {
-      printf("%02x %c ", buf[i], buf[i]);
+      COMM_Printf("%02x %c ", buf[i], buf[i]);
     } else { // nonalphanumeric as dot
-      printf("%02x %c ", buf[i], '.');
+      COMM_Printf("%02x %c ", buf[i], '.');
     }
 
     i++;
     // new line every 16 chars
     if ((i % 8) == 0) {
-      printf("\r\n");
+      COMM_Printf("\r\n");
     }
     // delay every 50 chars
     if ((i % 50) == 0) {
 //      TIMER_Delay(100); // Delay so as not to overflow buffer
     }
   }
-  printf("\r\n");
+  COMM_Printf("\r\n");
 }
 
 /**
@@ -130,22 +130,22 @@ void hexdump16C(const uint16_t const *buf, uint32_t length) {
   while (length--) {
 
     if (buf[i]>=' ' && buf[i] <= '~') {
-      printf("%04x %c ", buf[i], buf[i]);
+      COMM_Printf("%04x %c ", buf[i], buf[i]);
     } else { // nonalphanumeric as dot
-      printf("%04x %c ", buf[i], '.');
+      COMM_Printf("%04x %c ", buf[i], '.');
     }
 
     i++;
     // new line every 16 chars
     if ((i % 8) == 0) {
-      printf("\r\n");
+      COMM_Printf("\r\n");
     }
     // delay every 50 chars
     if ((i % 50) == 0) {
 //      TIMER_Delay(100); // Delay so as not to overflow buffer
     }
   }
-  printf("\r\n");
+  COMM_Printf("\r\n");
 }
 
 /**
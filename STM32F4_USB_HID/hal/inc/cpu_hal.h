@@ -0,0 +1,65 @@
+/**
+ * @file    cpu_hal.h
+ * @brief   HAL for core CPU functions
+ * @date    17 paź 2026
+ * @author  Michal Ksiezopolski
+ *
+ * @verbatim
+ * Copyright (c) 2026 Michal Ksiezopolski.
+ * All rights reserved. This program and the
+ * accompanying materials are made available
+ * under the terms of the GNU Public License
+ * v3.0 which accompanies this distribution,
+ * and is available at
+ * http://www.gnu.org/licenses/gpl.html
+ * @endverbatim
+ */
+
+#ifndef CPU_HAL_H_
+#define CPU_HAL_H_
+
+#include <inttypes.h>
+#include <stm32f4xx.h>
+
+/**
+ * @defgroup  CPU_HAL CPU_HAL
+ * @brief     HAL - core CPU functions.
+ */
+
+/**
+ * @addtogroup CPU_HAL
+ * @{
+ */
+
+/**
+ * @brief Disables interrupts.
+ * @details Can be nested - pass the returned state to
+ * CPU_HAL_ExitCritical.
+ * @return Previous interrupt state
+ */
+static inline uint32_t CPU_HAL_EnterCritical(void) {
+
+  uint32_t state = __get_PRIMASK();
+  __disable_irq();
+  return state;
+}
+/**
+ * @brief Restores interrupts disabled by CPU_HAL_EnterCritical.
+ * @param state Interrupt state returned by CPU_HAL_EnterCritical
+ */
+static inline void CPU_HAL_ExitCritical(uint32_t state) {
+  __set_PRIMASK(state);
+}
+/**
+ * @brief Checks if code runs in an interrupt handler.
+ * @return Nonzero in interrupt (handler) mode
+ */
+static inline uint32_t CPU_HAL_InInterrupt(void) {
+  return __get_IPSR();
+}
+
+/**
+ * @}
+ */
+
+#endif /* CPU_HAL_H_ */
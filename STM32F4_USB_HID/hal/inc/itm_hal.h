@@ -0,0 +1,39 @@
+/**
+ * @file    itm_hal.h
+ * @brief   HAL for the ITM stimulus ports (SWO output)
+ * @date    17 paź 2026
+ * @author  Michal Ksiezopolski
+ *
+ * @verbatim
+ * Copyright (c) 2026 Michal Ksiezopolski.
+ * All rights reserved. This program and the
+ * accompanying materials are made available
+ * under the terms of the GNU Public License
+ * v3.0 which accompanies this distribution,
+ * and is available at
+ * http://www.gnu.org/licenses/gpl.html
+ * @endverbatim
+ */
+
+#ifndef ITM_HAL_H_
+#define ITM_HAL_H_
+
+#include <inttypes.h>
+
+/**
+ * @defgroup  ITM_HAL ITM_HAL
+ * @brief     HAL - ITM stimulus port output.
+ */
+
+/**
+ * @addtogroup ITM_HAL
+ * @{
+ */
+
+uint16_t ITM_HAL_Write(uint8_t port, const uint8_t* data, uint16_t len);
+
+/**
+ * @}
+ */
+
+#endif /* ITM_HAL_H_ */
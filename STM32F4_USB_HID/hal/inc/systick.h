@@ -32,6 +32,8 @@
  */
 void      SYSTICK_Init    (uint32_t freq);
 uint32_t  SYSTICK_GetTime (void);
+uint64_t  SYSTICK_GetTime64(void);
+void      SYSTICK_Sleep   (uint32_t ticks);
 
 /**
  * @}
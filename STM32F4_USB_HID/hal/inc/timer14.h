@@ -1,38 +0,0 @@
-/**
- * @file    timer14.h
- * @brief   TIMER14 control
- * @date    10 paź 2014
- * @author  Michal Ksiezopolski
- * 
- * @verbatim
- * Copyright (c) 2014 Michal Ksiezopolski.
- * All rights reserved. This program and the 
- * accompanying materials are made available 
- * under the terms of the GNU Public License 
- * v3.0 which accompanies this distribution, 
- * and is available at 
- * http://www.gnu.org/licenses/gpl.html
- * @endverbatim
- */
-
-#ifndef TIMER14_H_
-#define TIMER14_H_
-
-/**
- * @defgroup  TIMER14 TIMER14
- * @brief     TIMER14 control functions
- */
-
-/**
- * @addtogroup TIMER14
- * @{
- */
-
-void TIMER14_Init(void);
-uint32_t TIMER14_GetTime(void);
-
-/**
- * @}
- */
-
-#endif /* TIMER14_H_ */
@@ -0,0 +1,42 @@
+/**
+ * @file    timer5.h
+ * @brief   TIMER5 free running high resolution time base
+ * @date    17 paź 2026
+ * @author  Michal Ksiezopolski
+ *
+ * @verbatim
+ * Copyright (c) 2026 Michal Ksiezopolski.
+ * All rights reserved. This program and the
+ * accompanying materials are made available
+ * under the terms of the GNU Public License
+ * v3.0 which accompanies this distribution,
+ * and is available at
+ * http://www.gnu.org/licenses/gpl.html
+ * @endverbatim
+ */
+
+#ifndef TIMER5_H_
+#define TIMER5_H_
+
+#include <inttypes.h>
+
+/**
+ * @defgroup  TIMER5 TIMER5
+ * @brief     TIMER5 time base functions
+ */
+
+/**
+ * @addtogroup TIMER5
+ * @{
+ */
+
+void      TIMER5_Init     (void);
+uint32_t  TIMER5_GetTime  (void);
+uint32_t  TIMER5_GetFreq  (void);
+void      TIMER5_DelayUS  (uint32_t us);
+
+/**
+ * @}
+ */
+
+#endif /* TIMER5_H_ */
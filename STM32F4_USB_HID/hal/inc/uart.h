@@ -0,0 +1,89 @@
+/**
+ * @file    uart.h
+ * @brief   Controlling USART1, USART2, USART3 and USART6
+ * @date    12 kwi 2014
+ * @author  Michal Ksiezopolski
+ * 
+ * @verbatim
+ * Copyright (c) 2014 Michal Ksiezopolski.
+ * All rights reserved. This program and the 
+ * accompanying materials are made available 
+ * under the terms of the GNU Public License 
+ * v3.0 which accompanies this distribution, 
+ * and is available at 
+ * http://www.gnu.org/licenses/gpl.html
+ * @endverbatim
+ */
+
+#ifndef UART_H_
+#define UART_H_
+
+#include <inttypes.h>
+#include <stm32f4xx.h>
+
+/**
+ * @defgroup  UART UART
+ * @brief     USART low level functions
+ */
+
+/**
+ * @addtogroup UART
+ * @{
+ */
+
+#ifndef UART_TX_DMA
+  #define UART_TX_DMA 1 ///< Transmit using DMA (0 - TXE interrupt per byte)
+#endif
+
+#ifndef UART_RX_DMA
+  #define UART_RX_DMA 1 ///< Receive using circular DMA (0 - RXNE interrupt per byte)
+#endif
+
+/**
+ * @brief Available USART ports.
+ */
+typedef enum {
+  UART_PORT1, ///< USART1 (TX PB6, RX PB7)
+  UART_PORT2, ///< USART2 (TX PA2, RX PA3)
+  UART_PORT3, ///< USART3 (TX PD8, RX PD9)
+  UART_PORT6, ///< USART6 (TX PC6, RX PC7)
+  UART_PORT_COUNT,
+} UART_Port_TypeDef;
+
+/**
+ * @brief USART line statistics.
+ */
+typedef struct {
+  uint32_t rxBytes;   ///< Received bytes
+  uint32_t txBytes;   ///< Transmitted bytes
+  uint32_t overruns;  ///< Overrun errors (ORE) - byte lost in hardware
+  uint32_t framing;   ///< Framing errors (FE)
+  uint32_t noise;     ///< Noise errors (NE)
+  uint32_t parity;    ///< Parity errors (PE)
+} UART_Stats_TypeDef;
+
+void    UART_Init(UART_Port_TypeDef port, uint32_t baud, void* ctx,
+    void(*rxCb)(void*, uint8_t), uint8_t(*txCb)(void*, uint8_t*));
+void    UART_InitTxDma(UART_Port_TypeDef port,
+    uint16_t(*txSpanCb)(void*, uint8_t**), void(*txDoneCb)(void*, uint16_t));
+void    UART_InitRxDma(UART_Port_TypeDef port, uint8_t* buf, uint16_t len,
+    void(*rxPosCb)(void*, uint16_t));
+void    UART_TxEnable(UART_Port_TypeDef port);
+void    UART_GetStats(UART_Port_TypeDef port, UART_Stats_TypeDef* stats);
+
+// HAL functions for use in higher level
+#define COMM_HAL_Init       UART_Init
+#define COMM_HAL_InitTxDma  UART_InitTxDma
+#define COMM_HAL_TX_DMA     UART_TX_DMA
+#define COMM_HAL_InitRxDma  UART_InitRxDma
+#define COMM_HAL_RX_DMA     UART_RX_DMA
+#define COMM_HAL_TxEnable   UART_TxEnable
+#define COMM_HAL_GetStats   UART_GetStats
+#define COMM_HAL_Stats_TypeDef UART_Stats_TypeDef
+#define COMM_HAL_CONSOLE    UART_PORT2 ///< Port used for the terminal
+
+/**
+ * @}
+ */
+
+#endif /* UART_H_ */
@@ -0,0 +1,70 @@
+/**
+ * @file    crc_hal.c
+ * @brief   HAL for the hardware CRC unit
+ * @date    17 paź 2026
+ * @author  Michal Ksiezopolski
+ *
+ * @verbatim
+ * Copyright (c) 2026 Michal Ksiezopolski.
+ * All rights reserved. This program and the
+ * accompanying materials are made available
+ * under the terms of the GNU Public License
+ * v3.0 which accompanies this distribution,
+ * and is available at
+ * http://www.gnu.org/licenses/gpl.html
+ * @endverbatim
+ */
+
+#include <crc_hal.h>
+#include <stm32f4xx.h>
+
+/**
+ * @addtogroup CRC_HAL
+ * @{
+ */
+
+/**
+ * @brief Initialize the CRC unit.
+ */
+void CRC_HAL_Init(void) {
+  RCC_AHB1PeriphClockCmd(RCC_AHB1Periph_CRC, ENABLE);
+}
+/**
+ * @brief Calculate CRC32 of a buffer.
+ * @details The CRC unit only takes 32 bit words (polynomial
+ * 0x04C11DB7, initial value 0xFFFFFFFF, no reflection, no final XOR).
+ * Bytes are fed most significant first and the last word is padded
+ * with zeros, so the result is CRC-32/MPEG-2 of the data padded
+ * with zeros to a multiple of 4 bytes.
+ * @warning Not reentrant - the CRC unit is shared.
+ * @param data Data
+ * @param len Length of data
+ * @return CRC32 value
+ */
+uint32_t CRC_HAL_Calc(const uint8_t* data, uint16_t len) {
+
+  uint32_t word;
+
+  CRC_ResetDR();
+
+  while (len >= 4) {
+    CRC_CalcCRC(((uint32_t)data[0] << 24) | ((uint32_t)data[1] << 16) |
+        ((uint32_t)data[2] << 8) | data[3]);
+    data += 4;
+    len -= 4;
+  }
+
+  if (len) { // pad last word with zeros
+    word = 0;
+    for (uint8_t i = 0; i < len; i++) {
+      word |= (uint32_t)data[i] << (24 - 8 * i);
+    }
+    CRC_CalcCRC(word);
+  }
+
+  return CRC_GetCRC();
+}
+
+/**
+ * @}
+ */
@@ -0,0 +1,65 @@
+/**
+ * @file    itm_hal.c
+ * @brief   HAL for the ITM stimulus ports (SWO output)
+ * @date    17 paź 2026
+ * @author  Michal Ksiezopolski
+ *
+ * @verbatim
+ * Copyright (c) 2026 Michal Ksiezopolski.
+ * All rights reserved. This program and the
+ * accompanying materials are made available
+ * under the terms of the GNU Public License
+ * v3.0 which accompanies this distribution,
+ * and is available at
+ * http://www.gnu.org/licenses/gpl.html
+ * @endverbatim
+ */
+
+#include <itm_hal.h>
+#include <stm32f4xx.h>
+
+/**
+ * @addtogroup ITM_HAL
+ * @{
+ */
+
+#define ITM_HAL_WAIT 64 ///< Maximum polls of a busy stimulus port per byte
+
+/**
+ * @brief Writes data to an ITM stimulus port.
+ * @details The ITM and SWO are set up by the debugger. Without a
+ * debugger (or with the port disabled) the data is thrown away. The
+ * function never blocks for long - if the port stays busy the rest
+ * of the data is not written.
+ * @param port Stimulus port (0-31)
+ * @param data Data
+ * @param len Length of data
+ * @return Number of bytes taken (len if nobody is listening)
+ */
+uint16_t ITM_HAL_Write(uint8_t port, const uint8_t* data, uint16_t len) {
+
+  uint16_t n;
+  uint8_t wait;
+
+  if (!(CoreDebug->DEMCR & CoreDebug_DEMCR_TRCENA_Msk) ||
+      !(ITM->TCR & ITM_TCR_ITMENA_Msk) || !(ITM->TER & (1UL << port))) {
+    return len;
+  }
+
+  for (n = 0; n < len; n++) {
+
+    // bounded wait for the stimulus port FIFO
+    for (wait = 0; ITM->PORT[port].u32 == 0; wait++) {
+      if (wait == ITM_HAL_WAIT) {
+        return n;
+      }
+    }
+    ITM->PORT[port].u8 = data[n];
+  }
+
+  return n;
+}
+
+/**
+ * @}
+ */
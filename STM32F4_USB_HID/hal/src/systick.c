@@ -16,6 +16,8 @@
  */
 
 #include <systick.h>
+#include <timer5.h>
+#include <cpu_hal.h>
 #include <stm32f4xx.h>
 
 /**
@@ -28,10 +30,15 @@
  * @{
  */
 
-static volatile uint32_t sysTicks;  ///< Delay timer.
+static volatile uint64_t sysTicks;  ///< Delay timer (never overflows).
+static uint32_t tickCycles;         ///< SysTick clock cycles per tick
+static uint32_t tickTimer;          ///< TIMER5 ticks per tick
+static volatile uint32_t tickStamp; ///< TIMER5 time of the last counted tick
 
 /**
  * @brief Initialize the SysTick with a given frequency
+ * @details Call after TIMER5_Init - the sleep time is measured
+ * with TIMER5.
  * @param freq SysTick frequency
  */
 void SYSTICK_Init(uint32_t freq) {
@@ -40,15 +47,148 @@ void SYSTICK_Init(uint32_t freq) {
 
   RCC_GetClocksFreq(&RCC_Clocks); // Complete the clocks structure with current clock settings.
 
-  SysTick_Config(RCC_Clocks.HCLK_Frequency / freq); // Set SysTick frequency
+  tickCycles = RCC_Clocks.HCLK_Frequency / freq;
+  tickTimer = TIMER5_GetFreq() / freq;
+
+  uint32_t state = CPU_HAL_EnterCritical();
+  tickStamp = TIMER5_GetTime(); // ticks come right after the stamps
+  SysTick_Config(tickCycles); // Set SysTick frequency
+  CPU_HAL_ExitCritical(state);
+
+  // Pending interrupts wake WFE even when masked (see SYSTICK_Sleep)
+  SCB->SCR |= SCB_SCR_SEVONPEND_Msk;
 
 }
 /**
  * @brief Get the system time
- * @return System time.
+ * @return System time (lower 32 bits, overflows every 49 days).
  */
 uint32_t SYSTICK_GetTime(void) {
-  return sysTicks;
+  return (uint32_t)sysTicks;
+}
+/**
+ * @brief Get the 64 bit system time.
+ * @details Can be called from any context. The time is read with
+ * interrupts disabled, so both halves come from the same tick.
+ * @return System time.
+ */
+uint64_t SYSTICK_GetTime64(void) {
+
+  uint32_t state = CPU_HAL_EnterCritical();
+  uint64_t time = sysTicks;
+  CPU_HAL_ExitCritical(state);
+
+  return time;
+}
+
+/**
+ * @brief Counts the ticks that passed since the last counted tick.
+ * @details The ticks are counted with TIMER5, which never stops, so
+ * neither the cycles the SysTick is stopped nor the interrupts held
+ * back for more than a tick are lost. Call with interrupts disabled.
+ * @return TIMER5 ticks since the last tick
+ */
+static uint32_t SYSTICK_Count(void) {
+
+  uint32_t passed;
+  uint32_t n;
+
+  passed = TIMER5_GetTime() - tickStamp;
+  if ((int32_t)passed < 0) { // the last tick came early (rounding)
+    passed = 0;
+  }
+
+  n = passed / tickTimer;
+  sysTicks += n;
+  tickStamp += n * tickTimer;
+
+  return passed - n * tickTimer;
+}
+/**
+ * @brief Stops the SysTick and counts the ticks that passed.
+ * @details A pending SysTick interrupt is cleared - its tick is
+ * counted here. Call with interrupts disabled.
+ * @return TIMER5 ticks since the last tick
+ */
+static uint32_t SYSTICK_Stop(void) {
+
+  SysTick->CTRL &= ~SysTick_CTRL_ENABLE_Msk;
+  SCB->ICSR = SCB_ICSR_PENDSTCLR_Msk;
+
+  return SYSTICK_Count();
+}
+/**
+ * @brief Starts the SysTick, so its next interrupt comes after
+ * a given time.
+ * @details Rounded up, so the interrupt never comes before the
+ * tick it counts. Call with interrupts disabled.
+ * @param timer Time in TIMER5 ticks (at most the 24 bit counter)
+ */
+static void SYSTICK_Start(uint32_t timer) {
+
+  uint32_t load = ((uint64_t)timer * tickCycles + tickTimer - 1) / tickTimer;
+
+  if (load < 2) { // counter doesn't run with LOAD = 0
+    load = 2;
+  }
+
+  SysTick->LOAD = load - 1;
+  SysTick->VAL = 0;
+  SysTick->CTRL |= SysTick_CTRL_ENABLE_Msk;
+}
+/**
+ * @brief Sleeps for a given number of ticks or until an interrupt.
+ *
+ * @details The SysTick is reprogrammed to interrupt only after
+ * the given number of ticks (limited by the 24 bit counter) and
+ * the core waits for an event. On wake up the ticks that passed
+ * are measured with TIMER5 and the SysTick is restarted in phase
+ * with the ticks, so the system time doesn't drift however often
+ * the core sleeps. If a tick was already due, the core doesn't
+ * sleep at all.
+ *
+ * WFE is used instead of WFI, because every exception return sets
+ * the event register. If an interrupt was handled after the caller
+ * checked for work, the sleep ends at once instead of waiting for
+ * the deadline.
+ *
+ * @param ticks Ticks to sleep
+ */
+void SYSTICK_Sleep(uint32_t ticks) {
+
+  uint32_t maxTicks = (SysTick_LOAD_RELOAD_Msk + 1) / tickCycles;
+  uint64_t start;
+  uint32_t phase; // TIMER5 ticks since the last tick
+
+  if (ticks > maxTicks) {
+    ticks = maxTicks;
+  }
+
+  if (ticks < 2) { // next tick interrupt wakes us up anyway
+    __DSB();
+    __WFE();
+    return;
+  }
+
+  uint32_t state = CPU_HAL_EnterCritical();
+
+  start = sysTicks;
+  phase = SYSTICK_Stop();
+
+  if (sysTicks == start) { // no tick due - sleep
+    SYSTICK_Start(ticks * tickTimer - phase);
+
+    __DSB();
+    __WFE();
+    __ISB();
+
+    phase = SYSTICK_Stop();
+  }
+
+  SYSTICK_Start(tickTimer - phase); // rest of the current tick
+  SysTick->LOAD = tickCycles - 1;   // used from next reload
+
+  CPU_HAL_ExitCritical(state); // pending interrupts run now
 }
 
 /**
@@ -56,7 +196,10 @@ uint32_t SYSTICK_GetTime(void) {
  */
 void SysTick_Handler(void) {
 
-  sysTicks++; // Update system time
+  // Higher priority interrupts must not see half of the update
+  uint32_t state = CPU_HAL_EnterCritical();
+  SYSTICK_Count(); // Update system time
+  CPU_HAL_ExitCritical(state);
 
 }
 
@@ -0,0 +1,101 @@
+/**
+ * @file    timer5.c
+ * @brief   TIMER5 free running high resolution time base
+ * @date    17 paź 2026
+ * @author  Michal Ksiezopolski
+ *
+ * @details TIM5 is a 32 bit timer. It counts the timer clock
+ * (84 MHz with the default clock setup - about 12 ns resolution)
+ * without a prescaler and overflows after about 51 s. No interrupts
+ * are used - the time is read directly from the counter register.
+ * Unlike the DWT cycle counter it keeps counting while the core
+ * sleeps in TIMER_Idle.
+ *
+ * @verbatim
+ * Copyright (c) 2026 Michal Ksiezopolski.
+ * All rights reserved. This program and the
+ * accompanying materials are made available
+ * under the terms of the GNU Public License
+ * v3.0 which accompanies this distribution,
+ * and is available at
+ * http://www.gnu.org/licenses/gpl.html
+ * @endverbatim
+ */
+
+#include <stm32f4xx.h>
+#include <timer5.h>
+
+/**
+ * @addtogroup TIMER5
+ * @{
+ */
+
+static uint32_t timerFreq;  ///< Counter frequency in Hz
+static uint32_t ticksPerUs; ///< Counter ticks per microsecond
+
+/**
+ * @brief Starts TIM5 as a free running counter.
+ */
+void TIMER5_Init(void) {
+
+  RCC_ClocksTypeDef RCC_Clocks;
+
+  RCC_GetClocksFreq(&RCC_Clocks);
+
+  // APB1 timers run at twice the bus clock if the bus is divided
+  timerFreq = RCC_Clocks.PCLK1_Frequency;
+  if ((RCC->CFGR & RCC_CFGR_PPRE1) != RCC_CFGR_PPRE1_DIV1) {
+    timerFreq *= 2;
+  }
+  ticksPerUs = timerFreq / 1000000;
+
+  RCC_APB1PeriphClockCmd(RCC_APB1Periph_TIM5, ENABLE);
+
+  TIM_TimeBaseInitTypeDef TIM_TimeBaseStructure;
+  TIM_TimeBaseStructure.TIM_Prescaler = 0;
+  TIM_TimeBaseStructure.TIM_CounterMode = TIM_CounterMode_Up;
+  TIM_TimeBaseStructure.TIM_Period = 0xFFFFFFFF; // use all 32 bits
+  TIM_TimeBaseStructure.TIM_ClockDivision = 0;
+  TIM_TimeBaseStructure.TIM_RepetitionCounter = 0;
+  TIM_TimeBaseInit(TIM5, &TIM_TimeBaseStructure);
+
+  TIM_Cmd(TIM5, ENABLE); // enable timer
+}
+/**
+ * @brief Returns the counter value.
+ * @return Counter ticks (see TIMER5_GetFreq)
+ */
+uint32_t TIMER5_GetTime(void) {
+  return TIM5->CNT;
+}
+/**
+ * @brief Returns the counter frequency.
+ * @return Ticks per second
+ */
+uint32_t TIMER5_GetFreq(void) {
+  return timerFreq;
+}
+/**
+ * @brief Busy waits for a given time.
+ * @details Waits at least us microseconds (longer if interrupted).
+ * Delays up to the counter period (about 51 s) are supported.
+ * @param us Microseconds to delay
+ */
+void TIMER5_DelayUS(uint32_t us) {
+
+  if (ticksPerUs == 0) { // not started yet (delay before TIMER_Init)
+    TIMER5_Init();
+  }
+
+  uint32_t start = TIM5->CNT;
+  uint32_t ticks = us * ticksPerUs;
+
+  // unsigned difference is correct across counter overflow
+  while (TIM5->CNT - start <= ticks) {
+    // Delay
+  }
+}
+
+/**
+ * @}
+ */
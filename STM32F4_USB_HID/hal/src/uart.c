@@ -0,0 +1,565 @@
+/**
+ * @file    uart.c
+ * @brief   Controlling USART1, USART2, USART3 and USART6
+ * @date    12 kwi 2014
+ * @author  Michal Ksiezopolski
+ *
+ * @verbatim
+ * Copyright (c) 2014 Michal Ksiezopolski.
+ * All rights reserved. This program and the
+ * accompanying materials are made available
+ * under the terms of the GNU Public License
+ * v3.0 which accompanies this distribution,
+ * and is available at
+ * http://www.gnu.org/licenses/gpl.html
+ * @endverbatim
+ */
+
+#include <uart.h>
+#include <stm32f4xx.h>
+
+/**
+ * @addtogroup UART
+ * @{
+ */
+
+/**
+ * @brief All DMA flags of a stream.
+ */
+#define UART_DMA_FLAGS(n) (DMA_FLAG_TCIF##n | DMA_FLAG_HTIF##n | \
+    DMA_FLAG_TEIF##n | DMA_FLAG_DMEIF##n | DMA_FLAG_FEIF##n)
+
+/**
+ * @brief Hardware resources of a USART port.
+ */
+typedef struct {
+  USART_TypeDef*      usart;      ///< USART peripheral
+  IRQn_Type           irq;        ///< USART interrupt
+  uint8_t             apb2;       ///< Nonzero if USART is on APB2 (else APB1)
+  uint32_t            clk;        ///< USART clock
+  GPIO_TypeDef*       gpio;       ///< GPIO port of TX and RX pins
+  uint32_t            gpioClk;    ///< GPIO clock
+  uint16_t            txPin;      ///< TX pin
+  uint16_t            rxPin;      ///< RX pin
+  uint8_t             txSource;   ///< TX pin source
+  uint8_t             rxSource;   ///< RX pin source
+  uint8_t             af;         ///< Alternate function
+  uint32_t            dmaClk;     ///< DMA controller clock
+  DMA_Stream_TypeDef* txStream;   ///< TX DMA stream
+  uint32_t            txChannel;  ///< TX DMA channel
+  IRQn_Type           txIrq;      ///< TX DMA stream interrupt
+  uint32_t            txTcIt;     ///< TX DMA transfer complete interrupt
+  uint32_t            txFlags;    ///< All TX DMA stream flags
+  DMA_Stream_TypeDef* rxStream;   ///< RX DMA stream
+  uint32_t            rxChannel;  ///< RX DMA channel
+  IRQn_Type           rxIrq;      ///< RX DMA stream interrupt
+  uint32_t            rxHtIt;     ///< RX DMA half transfer interrupt
+  uint32_t            rxTcIt;     ///< RX DMA transfer complete interrupt
+} UART_Hw_TypeDef;
+
+/**
+ * @brief Hardware resources of the ports (indexed by UART_Port_TypeDef)
+ */
+static const UART_Hw_TypeDef uartHw[UART_PORT_COUNT] = {
+  { // USART1
+    USART1, USART1_IRQn, 1, RCC_APB2Periph_USART1,
+    GPIOB, RCC_AHB1Periph_GPIOB, GPIO_Pin_6, GPIO_Pin_7,
+    GPIO_PinSource6, GPIO_PinSource7, GPIO_AF_USART1,
+    RCC_AHB1Periph_DMA2,
+    DMA2_Stream7, DMA_Channel_4, DMA2_Stream7_IRQn, DMA_IT_TCIF7, UART_DMA_FLAGS(7),
+    DMA2_Stream5, DMA_Channel_4, DMA2_Stream5_IRQn, DMA_IT_HTIF5, DMA_IT_TCIF5,
+  },
+  { // USART2
+    USART2, USART2_IRQn, 0, RCC_APB1Periph_USART2,
+    GPIOA, RCC_AHB1Periph_GPIOA, GPIO_Pin_2, GPIO_Pin_3,
+    GPIO_PinSource2, GPIO_PinSource3, GPIO_AF_USART2,
+    RCC_AHB1Periph_DMA1,
+    DMA1_Stream6, DMA_Channel_4, DMA1_Stream6_IRQn, DMA_IT_TCIF6, UART_DMA_FLAGS(6),
+    DMA1_Stream5, DMA_Channel_4, DMA1_Stream5_IRQn, DMA_IT_HTIF5, DMA_IT_TCIF5,
+  },
+  { // USART3
+    USART3, USART3_IRQn, 0, RCC_APB1Periph_USART3,
+    GPIOD, RCC_AHB1Periph_GPIOD, GPIO_Pin_8, GPIO_Pin_9,
+    GPIO_PinSource8, GPIO_PinSource9, GPIO_AF_USART3,
+    RCC_AHB1Periph_DMA1,
+    DMA1_Stream3, DMA_Channel_4, DMA1_Stream3_IRQn, DMA_IT_TCIF3, UART_DMA_FLAGS(3),
+    DMA1_Stream1, DMA_Channel_4, DMA1_Stream1_IRQn, DMA_IT_HTIF1, DMA_IT_TCIF1,
+  },
+  { // USART6
+    USART6, USART6_IRQn, 1, RCC_APB2Periph_USART6,
+    GPIOC, RCC_AHB1Periph_GPIOC, GPIO_Pin_6, GPIO_Pin_7,
+    GPIO_PinSource6, GPIO_PinSource7, GPIO_AF_USART6,
+    RCC_AHB1Periph_DMA2,
+    DMA2_Stream6, DMA_Channel_5, DMA2_Stream6_IRQn, DMA_IT_TCIF6, UART_DMA_FLAGS(6),
+    DMA2_Stream1, DMA_Channel_5, DMA2_Stream1_IRQn, DMA_IT_HTIF1, DMA_IT_TCIF1,
+  },
+};
+
+/**
+ * @brief Software state of a USART port.
+ */
+typedef struct {
+  void*    ctx;                                   ///< Passed to all callbacks
+  void     (*rxCallback)(void*, uint8_t);         ///< Callback function for receiving data
+  uint8_t  (*txCallback)(void*, uint8_t*);        ///< Callback function for transmitting data
+#if UART_TX_DMA
+  uint16_t (*txSpanCallback)(void*, uint8_t**);   ///< Callback returning next block to transmit
+  void     (*txDoneCallback)(void*, uint16_t);    ///< Callback releasing transmitted block
+  volatile uint16_t txDmaLen;                     ///< Length of current DMA transfer (0 - DMA idle)
+#endif
+#if UART_RX_DMA
+  void     (*rxPosCallback)(void*, uint16_t);     ///< Callback signaling new DMA write position
+  uint16_t rxDmaLen;                              ///< Length of circular RX buffer
+  uint16_t rxDmaPos;                              ///< Last reported DMA write position
+#endif
+  UART_Stats_TypeDef stats;                       ///< Line statistics
+} UART_State_TypeDef;
+
+static UART_State_TypeDef uartState[UART_PORT_COUNT]; ///< State of the ports
+
+/**
+ * @brief Initialize a USART port
+ * @param port Port to initialize
+ * @param baud Baud rate
+ * @param ctx Context passed to all callbacks of the port
+ * @param rxCb Callback for received data (RXNE mode)
+ * @param txCb Callback for data to transmit (TXE mode)
+ */
+void UART_Init(UART_Port_TypeDef port, uint32_t baud, void* ctx,
+    void(*rxCb)(void*, uint8_t), uint8_t(*txCb)(void*, uint8_t*)) {
+
+  const UART_Hw_TypeDef* hw = &uartHw[port];
+  UART_State_TypeDef* state = &uartState[port];
+
+  // assign the callbacks
+  state->ctx = ctx;
+  state->rxCallback = rxCb;
+  state->txCallback = txCb;
+
+  GPIO_InitTypeDef  GPIO_InitStructure;
+  USART_InitTypeDef USART_InitStructure;
+
+  // Enable clocks for peripherals
+  if (hw->apb2) {
+    RCC_APB2PeriphClockCmd(hw->clk, ENABLE);
+  } else {
+    RCC_APB1PeriphClockCmd(hw->clk, ENABLE);
+  }
+  RCC_AHB1PeriphClockCmd(hw->gpioClk, ENABLE);
+
+  // USART TX
+  GPIO_InitStructure.GPIO_Pin   = hw->txPin;
+  GPIO_InitStructure.GPIO_Mode  = GPIO_Mode_AF;
+  GPIO_InitStructure.GPIO_Speed = GPIO_Speed_50MHz;
+  GPIO_InitStructure.GPIO_OType = GPIO_OType_PP;
+  GPIO_InitStructure.GPIO_PuPd  = GPIO_PuPd_UP ;
+  GPIO_Init(hw->gpio, &GPIO_InitStructure);
+
+  // USART RX
+  GPIO_InitStructure.GPIO_Pin   = hw->rxPin;
+  GPIO_InitStructure.GPIO_Mode  = GPIO_Mode_AF;
+  GPIO_InitStructure.GPIO_Speed = GPIO_Speed_50MHz;
+  GPIO_InitStructure.GPIO_OType = GPIO_OType_PP;
+  GPIO_InitStructure.GPIO_PuPd  = GPIO_PuPd_UP;
+  GPIO_Init(hw->gpio, &GPIO_InitStructure);
+
+  // Connect USART pins to AF
+  GPIO_PinAFConfig(hw->gpio, hw->txSource, hw->af);
+  GPIO_PinAFConfig(hw->gpio, hw->rxSource, hw->af);
+
+  // USART initialization (standard 8n1)
+  USART_InitStructure.USART_BaudRate            = baud;
+  USART_InitStructure.USART_WordLength          = USART_WordLength_8b;
+  USART_InitStructure.USART_StopBits            = USART_StopBits_1;
+  USART_InitStructure.USART_Parity              = USART_Parity_No;
+  USART_InitStructure.USART_HardwareFlowControl = USART_HardwareFlowControl_None;
+  USART_InitStructure.USART_Mode                = USART_Mode_Rx | USART_Mode_Tx;
+  USART_Init(hw->usart, &USART_InitStructure);
+
+  // Enable USART
+  USART_Cmd(hw->usart, ENABLE);
+
+#if !UART_RX_DMA
+  // Enable RXNE interrupt
+  USART_ITConfig(hw->usart, USART_IT_RXNE, ENABLE);
+#endif
+  // Enable line error interrupts (ORE, FE, NE with DMA and PE) -
+  // in RXNE mode they come together with RXNE anyway
+  USART_ITConfig(hw->usart, USART_IT_ERR, ENABLE);
+  USART_ITConfig(hw->usart, USART_IT_PE, ENABLE);
+  // Disable TXE interrupt - we enable it only when there is
+  // data to send
+  USART_ITConfig(hw->usart, USART_IT_TXE, DISABLE);
+
+  // Enable USART global interrupt
+  NVIC_EnableIRQ(hw->irq);
+
+}
+#if UART_TX_DMA
+/**
+ * @brief Initialize DMA transmission for a USART port.
+ * @details Each transfer sends the largest contiguous block the
+ * higher layer has and the next block is chained from the transfer
+ * complete interrupt. Call after UART_Init.
+ * @param port USART port
+ * @param txSpanCb Callback returning the next contiguous block (0 - no data)
+ * @param txDoneCb Callback releasing a transmitted block
+ */
+void UART_InitTxDma(UART_Port_TypeDef port,
+    uint16_t(*txSpanCb)(void*, uint8_t**), void(*txDoneCb)(void*, uint16_t)) {
+
+  const UART_Hw_TypeDef* hw = &uartHw[port];
+  UART_State_TypeDef* state = &uartState[port];
+  DMA_InitTypeDef DMA_InitStructure;
+
+  state->txSpanCallback = txSpanCb;
+  state->txDoneCallback = txDoneCb;
+  state->txDmaLen = 0;
+
+  RCC_AHB1PeriphClockCmd(hw->dmaClk, ENABLE);
+
+  DMA_DeInit(hw->txStream);
+
+  // memory address and length are set for each transfer
+  DMA_StructInit(&DMA_InitStructure);
+  DMA_InitStructure.DMA_Channel            = hw->txChannel;
+  DMA_InitStructure.DMA_PeripheralBaseAddr = (uint32_t)&hw->usart->DR;
+  DMA_InitStructure.DMA_DIR                = DMA_DIR_MemoryToPeripheral;
+  DMA_InitStructure.DMA_BufferSize         = 1;
+  DMA_InitStructure.DMA_PeripheralInc      = DMA_PeripheralInc_Disable;
+  DMA_InitStructure.DMA_MemoryInc          = DMA_MemoryInc_Enable;
+  DMA_InitStructure.DMA_PeripheralDataSize = DMA_PeripheralDataSize_Byte;
+  DMA_InitStructure.DMA_MemoryDataSize     = DMA_MemoryDataSize_Byte;
+  DMA_InitStructure.DMA_Mode               = DMA_Mode_Normal;
+  DMA_InitStructure.DMA_Priority           = DMA_Priority_Low;
+  DMA_Init(hw->txStream, &DMA_InitStructure);
+
+  DMA_ITConfig(hw->txStream, DMA_IT_TC, ENABLE);
+  USART_DMACmd(hw->usart, USART_DMAReq_Tx, ENABLE);
+
+  NVIC_EnableIRQ(hw->txIrq);
+}
+/**
+ * @brief Starts a DMA transfer of the next block (if any).
+ * @details Called when DMA is idle - from the higher layer or from
+ * the transfer complete interrupt.
+ * @param port USART port
+ */
+static inline void UART_StartTxDma(UART_Port_TypeDef port) {
+
+  const UART_Hw_TypeDef* hw = &uartHw[port];
+  UART_State_TypeDef* state = &uartState[port];
+  uint8_t* data;
+  uint16_t len = state->txSpanCallback(state->ctx, &data);
+
+  state->txDmaLen = len;
+
+  if (len == 0) { // nothing more to send
+    return;
+  }
+
+  hw->txStream->M0AR = (uint32_t)data;
+  hw->txStream->NDTR = len;
+  state->stats.txBytes += len;
+  DMA_ClearFlag(hw->txStream, hw->txFlags);
+  DMA_Cmd(hw->txStream, ENABLE);
+}
+#endif
+#if UART_RX_DMA
+/**
+ * @brief Initialize circular DMA reception for a USART port.
+ * @details The DMA runs in circular mode, writing straight into buf.
+ * The higher layer gets the current write position on the half
+ * transfer, transfer complete and IDLE line interrupts, so it is
+ * notified at least twice per buffer pass and whenever the line
+ * goes quiet after a burst. Call after UART_Init.
+ * @param port USART port
+ * @param buf Circular buffer (used as long as reception is running)
+ * @param len Length of buffer
+ * @param rxPosCb Callback getting the position of the next byte DMA writes
+ */
+void UART_InitRxDma(UART_Port_TypeDef port, uint8_t* buf, uint16_t len,
+    void(*rxPosCb)(void*, uint16_t)) {
+
+  const UART_Hw_TypeDef* hw = &uartHw[port];
+  UART_State_TypeDef* state = &uartState[port];
+  DMA_InitTypeDef DMA_InitStructure;
+
+  state->rxPosCallback = rxPosCb;
+  state->rxDmaLen = len;
+  state->rxDmaPos = 0;
+
+  RCC_AHB1PeriphClockCmd(hw->dmaClk, ENABLE);
+
+  DMA_DeInit(hw->rxStream);
+
+  DMA_StructInit(&DMA_InitStructure);
+  DMA_InitStructure.DMA_Channel            = hw->rxChannel;
+  DMA_InitStructure.DMA_PeripheralBaseAddr = (uint32_t)&hw->usart->DR;
+  DMA_InitStructure.DMA_Memory0BaseAddr    = (uint32_t)buf;
+  DMA_InitStructure.DMA_DIR                = DMA_DIR_PeripheralToMemory;
+  DMA_InitStructure.DMA_BufferSize         = len;
+  DMA_InitStructure.DMA_PeripheralInc      = DMA_PeripheralInc_Disable;
+  DMA_InitStructure.DMA_MemoryInc          = DMA_MemoryInc_Enable;
+  DMA_InitStructure.DMA_PeripheralDataSize = DMA_PeripheralDataSize_Byte;
+  DMA_InitStructure.DMA_MemoryDataSize     = DMA_MemoryDataSize_Byte;
+  DMA_InitStructure.DMA_Mode               = DMA_Mode_Circular;
+  DMA_InitStructure.DMA_Priority           = DMA_Priority_High;
+  DMA_Init(hw->rxStream, &DMA_InitStructure);
+
+  DMA_ITConfig(hw->rxStream, DMA_IT_HT | DMA_IT_TC, ENABLE);
+  USART_DMACmd(hw->usart, USART_DMAReq_Rx, ENABLE);
+  DMA_Cmd(hw->rxStream, ENABLE);
+
+  // the line going idle ends a burst of data
+  USART_ITConfig(hw->usart, USART_IT_IDLE, ENABLE);
+
+  NVIC_EnableIRQ(hw->rxIrq);
+}
+/**
+ * @brief Passes current DMA write position to the higher layer.
+ * @param port USART port
+ */
+static inline void UART_RxDmaUpdate(UART_Port_TypeDef port) {
+
+  UART_State_TypeDef* state = &uartState[port];
+  uint16_t pos = state->rxDmaLen - DMA_GetCurrDataCounter(uartHw[port].rxStream);
+
+  if (pos == state->rxDmaLen) { // counter was just reloaded
+    pos = 0;
+  }
+
+  if (pos >= state->rxDmaPos) {
+    state->stats.rxBytes += pos - state->rxDmaPos;
+  } else {
+    state->stats.rxBytes += state->rxDmaLen - state->rxDmaPos + pos;
+  }
+  state->rxDmaPos = pos;
+
+  state->rxPosCallback(state->ctx, pos);
+}
+#endif
+/**
+ * @brief Enable transmitter.
+ * @details This function has to be called by the higher layer
+ * in order to start the transmitter.
+ * @param port USART port
+ */
+void UART_TxEnable(UART_Port_TypeDef port) {
+
+#if UART_TX_DMA
+  // If a transfer is running, the interrupt will pick up the new data.
+  // The interrupt can't start a transfer when DMA is idle, so there
+  // is no race here.
+  if (uartState[port].txDmaLen == 0 && uartState[port].txSpanCallback) {
+    UART_StartTxDma(port);
+  }
+#else
+  USART_ITConfig(uartHw[port].usart, USART_IT_TXE, ENABLE);
+#endif
+}
+/**
+ * @brief Read the line statistics.
+ * @param port USART port
+ * @param stats Copy of the statistics
+ */
+void UART_GetStats(UART_Port_TypeDef port, UART_Stats_TypeDef* stats) {
+  *stats = uartState[port].stats;
+}
+
+/**
+ * @brief Common IRQ handler for the USART ports
+ * @details Inlined in every handler, so port is a constant there.
+ * @param port USART port
+ */
+static inline void UART_IRQHandler(UART_Port_TypeDef port) {
+
+  USART_TypeDef* usart = uartHw[port].usart;
+  UART_State_TypeDef* state = &uartState[port];
+
+  // Line errors are cleared by reading SR followed by DR. An
+  // uncleared ORE would keep the interrupt firing.
+  uint16_t status = usart->SR;
+
+  if (status & (USART_FLAG_ORE | USART_FLAG_FE | USART_FLAG_NE | USART_FLAG_PE)) {
+
+    if (status & USART_FLAG_ORE) {
+      state->stats.overruns++;
+    }
+    if (status & USART_FLAG_FE) {
+      state->stats.framing++;
+    }
+    if (status & USART_FLAG_NE) {
+      state->stats.noise++;
+    }
+    if (status & USART_FLAG_PE) {
+      state->stats.parity++;
+    }
+
+#if UART_RX_DMA
+    // DMA may have taken the data already - read DR to finish clearing
+    USART_ReceiveData(usart);
+#endif
+    // in RXNE mode the data register is read below
+  }
+
+  // If transmit buffer empty interrupt
+  if(USART_GetITStatus(usart, USART_IT_TXE) != RESET) {
+
+    uint8_t c;
+
+    if (state->txCallback) { // if not NULL
+      // get data from higher layer using callback
+      if (state->txCallback(state->ctx, &c)) {
+        USART_SendData(usart, c); // Send data
+        state->stats.txBytes++;
+      } else { // if no more data to send disable the transmitter
+        USART_ITConfig(usart, USART_IT_TXE, DISABLE);
+      }
+    }
+  }
+
+  // If RX buffer not empty interrupt
+  if(USART_GetITStatus(usart, USART_IT_RXNE) != RESET) {
+
+    uint8_t c = USART_ReceiveData(usart); // Get data from UART
+    state->stats.rxBytes++;
+
+    if (state->rxCallback) { // if not NULL
+      state->rxCallback(state->ctx, c); // send received data to higher layer
+    }
+  }
+
+#if UART_RX_DMA
+  // If line is idle (end of burst)
+  if(USART_GetITStatus(usart, USART_IT_IDLE) != RESET) {
+
+    USART_ReceiveData(usart); // clears IDLE (after reading SR)
+    UART_RxDmaUpdate(port);
+  }
+#endif
+}
+
+#if UART_TX_DMA
+/**
+ * @brief Common IRQ handler for the TX DMA streams
+ * @param port USART port
+ */
+static inline void UART_TxDmaIRQHandler(UART_Port_TypeDef port) {
+
+  const UART_Hw_TypeDef* hw = &uartHw[port];
+  UART_State_TypeDef* state = &uartState[port];
+
+  if (DMA_GetITStatus(hw->txStream, hw->txTcIt) != RESET) {
+
+    DMA_ClearITPendingBit(hw->txStream, hw->txTcIt);
+
+    state->txDoneCallback(state->ctx, state->txDmaLen); // release transmitted block
+    UART_StartTxDma(port); // chain next block (wrapped part or new data)
+  }
+}
+#endif
+
+#if UART_RX_DMA
+/**
+ * @brief Common IRQ handler for the RX DMA streams
+ * @param port USART port
+ */
+static inline void UART_RxDmaIRQHandler(UART_Port_TypeDef port) {
+
+  const UART_Hw_TypeDef* hw = &uartHw[port];
+
+  if (DMA_GetITStatus(hw->rxStream, hw->rxHtIt) != RESET) {
+    DMA_ClearITPendingBit(hw->rxStream, hw->rxHtIt);
+    UART_RxDmaUpdate(port);
+  }
+
+  if (DMA_GetITStatus(hw->rxStream, hw->rxTcIt) != RESET) {
+    DMA_ClearITPendingBit(hw->rxStream, hw->rxTcIt);
+    UART_RxDmaUpdate(port);
+  }
+}
+#endif
+
+/**
+ * @brief IRQ handler for USART1
+ */
+void USART1_IRQHandler(void) {
+  UART_IRQHandler(UART_PORT1);
+}
+/**
+ * @brief IRQ handler for USART2
+ */
+void USART2_IRQHandler(void) {
+  UART_IRQHandler(UART_PORT2);
+}
+/**
+ * @brief IRQ handler for USART3
+ */
+void USART3_IRQHandler(void) {
+  UART_IRQHandler(UART_PORT3);
+}
+/**
+ * @brief IRQ handler for USART6
+ */
+void USART6_IRQHandler(void) {
+  UART_IRQHandler(UART_PORT6);
+}
+
+#if UART_TX_DMA
+/**
+ * @brief IRQ handler for DMA2 Stream7 (USART1 TX)
+ */
+void DMA2_Stream7_IRQHandler(void) {
+  UART_TxDmaIRQHandler(UART_PORT1);
+}
+/**
+ * @brief IRQ handler for DMA1 Stream6 (USART2 TX)
+ */
+void DMA1_Stream6_IRQHandler(void) {
+  UART_TxDmaIRQHandler(UART_PORT2);
+}
+/**
+ * @brief IRQ handler for DMA1 Stream3 (USART3 TX)
+ */
+void DMA1_Stream3_IRQHandler(void) {
+  UART_TxDmaIRQHandler(UART_PORT3);
+}
+/**
+ * @brief IRQ handler for DMA2 Stream6 (USART6 TX)
+ */
+void DMA2_Stream6_IRQHandler(void) {
+  UART_TxDmaIRQHandler(UART_PORT6);
+}
+#endif
+
+#if UART_RX_DMA
+/**
+ * @brief IRQ handler for DMA2 Stream5 (USART1 RX)
+ */
+void DMA2_Stream5_IRQHandler(void) {
+  UART_RxDmaIRQHandler(UART_PORT1);
+}
+/**
+ * @brief IRQ handler for DMA1 Stream5 (USART2 RX)
+ */
+void DMA1_Stream5_IRQHandler(void) {
+  UART_RxDmaIRQHandler(UART_PORT2);
+}
+/**
+ * @brief IRQ handler for DMA1 Stream1 (USART3 RX)
+ */
+void DMA1_Stream1_IRQHandler(void) {
+  UART_RxDmaIRQHandler(UART_PORT3);
+}
+/**
+ * @brief IRQ handler for DMA2 Stream1 (USART6 RX)
+ */
+void DMA2_Stream1_IRQHandler(void) {
+  UART_RxDmaIRQHandler(UART_PORT6);
+}
+#endif
+
+/**
+ * @}
+ */
@@ -34,9 +34,13 @@
 #include "usbd_hid_core.h"
 #include "usb_conf.h"
 #include <usb_dcd_int.h>
+#include <timer5.h>
+#include <cpu_hal.h>
 
 extern USB_OTG_CORE_HANDLE USB_OTG_dev;
 
+static void (*idleHook)(void); ///< Run while waiting in USB_OTG_BSP_mDelay
+
 /** @addtogroup STM32_USB_OTG_DEVICE_LIBRARY
 * @{
 */
@@ -218,30 +222,53 @@ void USB_OTG_BSP_EnableInterrupt(USB_OTG_CORE_HANDLE *pdev) {
 }
 /**
 * @brief  USB_OTG_BSP_uDelay
-*         This function provides delay time in micro sec
+*         This function provides delay time in micro sec (at least usec)
 * @param  usec : Value of delay required in micro sec
 * @retval None
 */
 void USB_OTG_BSP_uDelay (const uint32_t usec) {
-  uint32_t count = 0;
-  const uint32_t utime = (120 * usec / 7);
-  do
-  {
-    if ( ++count > utime )
-    {
-      return ;
-    }
-  }
-  while (1);
+  TIMER5_DelayUS(usec); // independent of core clock and optimization
 }
 /**
 * @brief  USB_OTG_BSP_mDelay
-*          This function provides delay time in milli sec
+*          This function provides delay time in milli sec (at least msec).
+*          The idle hook runs while waiting (see USB_OTG_BSP_SetIdleHook)
 * @param  msec : Value of delay required in milli sec
 * @retval None
 */
 void USB_OTG_BSP_mDelay (const uint32_t msec) {
-  USB_OTG_BSP_uDelay(msec * 1000);   
+
+  static uint8_t inHook; // the hook may call the USB stack again
+  uint32_t start;
+  uint32_t ticks;
+
+  // no hook in interrupts (remote wakeup) or before the time base runs
+  if (idleHook == NULL || inHook || CPU_HAL_InInterrupt() ||
+      TIMER5_GetFreq() == 0) {
+    USB_OTG_BSP_uDelay(msec * 1000);
+    return;
+  }
+
+  start = TIMER5_GetTime();
+  ticks = msec * (TIMER5_GetFreq() / 1000);
+
+  // the delay can be longer by one run of the hook, never shorter
+  inHook = 1;
+  while (TIMER5_GetTime() - start <= ticks) {
+    idleHook();
+  }
+  inHook = 0;
+}
+/**
+* @brief  USB_OTG_BSP_SetIdleHook
+*         Sets a function run repeatedly during USB_OTG_BSP_mDelay, so
+*         the main loop keeps working while the USB core initializes.
+*         Not used in interrupts. Set after TIMER_Init.
+* @param  hook : Function to run (NULL - plain busy wait)
+* @retval None
+*/
+void USB_OTG_BSP_SetIdleHook(void (*hook)(void)) {
+  idleHook = hook;
 }
 
 /**
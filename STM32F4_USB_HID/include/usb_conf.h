@@ -237,6 +237,7 @@
 /** @defgroup USB_CONF_Exported_FunctionsPrototype
   * @{
   */ 
+void USB_OTG_BSP_SetIdleHook(void (*hook)(void));
 /**
   * @}
   */ 
@@ -0,0 +1,38 @@
+/**
+ * @file    cpu_hal.h
+ * @brief   Host replacement of the CPU HAL
+ * @date    17 paź 2026
+ * @author  Michal Ksiezopolski
+ *
+ * @details The tests run in a single thread of main loop code, so
+ * critical sections do nothing and there are no interrupts.
+ *
+ * @verbatim
+ * Copyright (c) 2026 Michal Ksiezopolski.
+ * All rights reserved. This program and the
+ * accompanying materials are made available
+ * under the terms of the GNU Public License
+ * v3.0 which accompanies this distribution,
+ * and is available at
+ * http://www.gnu.org/licenses/gpl.html
+ * @endverbatim
+ */
+
+#ifndef CPU_HAL_H_
+#define CPU_HAL_H_
+
+#include <inttypes.h>
+
+static inline uint32_t CPU_HAL_EnterCritical(void) {
+  return 0;
+}
+
+static inline void CPU_HAL_ExitCritical(uint32_t state) {
+  (void)state;
+}
+
+static inline uint32_t CPU_HAL_InInterrupt(void) {
+  return 0;
+}
+
+#endif /* CPU_HAL_H_ */
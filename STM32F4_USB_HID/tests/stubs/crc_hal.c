@@ -0,0 +1,46 @@
+/**
+ * @file    crc_hal.c
+ * @brief   Software replacement of the CRC unit for the host tests
+ * @date    17 paź 2026
+ * @author  Michal Ksiezopolski
+ *
+ * @details Gives the same results as hal/src/crc_hal.c - bytes are
+ * fed most significant first in 32 bit words and the last word is
+ * padded with zeros.
+ *
+ * @verbatim
+ * Copyright (c) 2026 Michal Ksiezopolski.
+ * All rights reserved. This program and the
+ * accompanying materials are made available
+ * under the terms of the GNU Public License
+ * v3.0 which accompanies this distribution,
+ * and is available at
+ * http://www.gnu.org/licenses/gpl.html
+ * @endverbatim
+ */
+
+#include <crc_hal.h>
+
+void CRC_HAL_Init(void) {
+}
+
+uint32_t CRC_HAL_Calc(const uint8_t* data, uint16_t len) {
+
+  uint32_t crc = 0xFFFFFFFF;
+  uint32_t word;
+
+  for (uint16_t i = 0; i < len; i += 4) {
+
+    word = 0;
+    for (uint8_t k = 0; k < 4; k++) {
+      word = (word << 8) | (i + k < len ? data[i + k] : 0);
+    }
+
+    crc ^= word;
+    for (uint8_t bit = 0; bit < 32; bit++) {
+      crc = (crc & 0x80000000) ? (crc << 1) ^ 0x04C11DB7 : crc << 1;
+    }
+  }
+
+  return crc;
+}
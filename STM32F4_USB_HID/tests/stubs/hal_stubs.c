@@ -0,0 +1,88 @@
+/**
+ * @file    hal_stubs.c
+ * @brief   Fake time base and ITM for the host tests
+ * @date    17 paź 2026
+ * @author  Michal Ksiezopolski
+ *
+ * @verbatim
+ * Copyright (c) 2026 Michal Ksiezopolski.
+ * All rights reserved. This program and the
+ * accompanying materials are made available
+ * under the terms of the GNU Public License
+ * v3.0 which accompanies this distribution,
+ * and is available at
+ * http://www.gnu.org/licenses/gpl.html
+ * @endverbatim
+ */
+
+#include <hal_stubs.h>
+#include <systick.h>
+#include <timer5.h>
+#include <itm_hal.h>
+#include <stddef.h>
+
+uint64_t stubTime;
+uint32_t stubCycles;
+uint32_t stubSleeps;
+uint32_t stubSleepMax;
+uint32_t stubItmBytes;
+void (*stubItmHook)(void);
+
+static uint32_t stubCycleOffset; ///< Cycles added by reads
+
+void SYSTICK_Init(uint32_t freq) {
+  (void)freq;
+}
+
+uint32_t SYSTICK_GetTime(void) {
+  return (uint32_t)stubTime;
+}
+
+uint64_t SYSTICK_GetTime64(void) {
+  return stubTime;
+}
+
+/**
+ * @brief Sleeps until the next tick interrupt.
+ * @details The time jumps to the wake up - after ticks ms, or earlier
+ * if a fake interrupt comes first (stubSleepMax).
+ */
+void SYSTICK_Sleep(uint32_t ticks) {
+
+  if (stubSleepMax && ticks > stubSleepMax) {
+    ticks = stubSleepMax;
+  }
+  stubSleeps++;
+  stubTime += ticks;
+}
+
+void TIMER5_Init(void) {
+}
+
+uint32_t TIMER5_GetTime(void) {
+  stubCycleOffset += stubCycles;
+  return (uint32_t)(stubTime * 84000) + stubCycleOffset;
+}
+
+uint32_t TIMER5_GetFreq(void) {
+  return 84000000;
+}
+
+void TIMER5_DelayUS(uint32_t us) {
+  (void)us;
+}
+
+uint16_t ITM_HAL_Write(uint8_t port, const uint8_t* data, uint16_t len) {
+
+  void (*hook)(void) = stubItmHook;
+
+  (void)port;
+  (void)data;
+
+  if (hook) {
+    stubItmHook = NULL;
+    hook();
+  }
+  stubItmBytes += len;
+  return len;
+}
@@ -0,0 +1,33 @@
+/**
+ * @file    hal_stubs.h
+ * @brief   Fake time base and ITM for the host tests
+ * @date    17 paź 2026
+ * @author  Michal Ksiezopolski
+ *
+ * @details SysTick time is a variable advanced by the test (or by
+ * SYSTICK_Sleep). TIMER5 counts 84 ticks per us of the same time.
+ *
+ * @verbatim
+ * Copyright (c) 2026 Michal Ksiezopolski.
+ * All rights reserved. This program and the
+ * accompanying materials are made available
+ * under the terms of the GNU Public License
+ * v3.0 which accompanies this distribution,
+ * and is available at
+ * http://www.gnu.org/licenses/gpl.html
+ * @endverbatim
+ */
+
+#ifndef HAL_STUBS_H_
+#define HAL_STUBS_H_
+
+#include <inttypes.h>
+
+extern uint64_t stubTime;     ///< System time in ms
+extern uint32_t stubCycles;   ///< Added to TIMER5 time on every read
+extern uint32_t stubSleeps;   ///< Number of SYSTICK_Sleep calls
+extern uint32_t stubSleepMax; ///< Interrupt wakes a sleep after this many ms (0 - never)
+extern uint32_t stubItmBytes; ///< Bytes written to the ITM
+extern void (*stubItmHook)(void); ///< Called during the next ITM write (an interrupt)
+
+#endif /* HAL_STUBS_H_ */
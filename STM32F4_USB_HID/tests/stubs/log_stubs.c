@@ -0,0 +1,29 @@
+/**
+ * @file    log_stubs.c
+ * @brief   Silent LOG for tests of other modules
+ * @date    17 paź 2026
+ * @author  Michal Ksiezopolski
+ *
+ * @verbatim
+ * Copyright (c) 2026 Michal Ksiezopolski.
+ * All rights reserved. This program and the
+ * accompanying materials are made available
+ * under the terms of the GNU Public License
+ * v3.0 which accompanies this distribution,
+ * and is available at
+ * http://www.gnu.org/licenses/gpl.html
+ * @endverbatim
+ */
+
+#include <log.h>
+
+uint8_t logLevels[LOG_MODULE_COUNT]; // all modules LOG_OFF
+
+uint8_t LOG_Allow(LOG_Module_TypeDef module, LOG_Level_TypeDef level,
+    LOG_Limit_TypeDef* limit, uint32_t ms) {
+  return 0;
+}
+
+void LOG_Print(LOG_Module_TypeDef module, LOG_Level_TypeDef level,
+    const char* fmt, ...) {
+}
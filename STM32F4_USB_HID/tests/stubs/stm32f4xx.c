@@ -0,0 +1,23 @@
+/**
+ * @file    stm32f4xx.c
+ * @brief   Host replacement of the peripherals used by the UART HAL
+ * @date    17 paź 2026
+ * @author  Michal Ksiezopolski
+ *
+ * @verbatim
+ * Copyright (c) 2026 Michal Ksiezopolski.
+ * All rights reserved. This program and the
+ * accompanying materials are made available
+ * under the terms of the GNU Public License
+ * v3.0 which accompanies this distribution,
+ * and is available at
+ * http://www.gnu.org/licenses/gpl.html
+ * @endverbatim
+ */
+
+#include <stm32f4xx.h>
+
+USART_TypeDef stubUsart[4];
+GPIO_TypeDef stubGpio[4];
+DMA_Stream_TypeDef stubDma1[8];
+DMA_Stream_TypeDef stubDma2[8];
@@ -0,0 +1,313 @@
+/**
+ * @file    stm32f4xx.h
+ * @brief   Host replacement of the device header and StdPeriph drivers
+ * @date    17 paź 2026
+ * @author  Michal Ksiezopolski
+ *
+ * @details Just enough for hal/src/uart.c and hal/src/systick.c. The
+ * UART peripherals are variables (see stm32f4xx.c) and the driver
+ * functions only change them where a test looks at the result:
+ * DMA_Cmd sets or clears the enable bit of a stream and each stream
+ * keeps its own interrupt flags in ISR. Everything else does nothing.
+ *
+ * SysTick, SCB and WFE are simulated by the test using them: every
+ * access goes through a function, so the test can let time pass
+ * and act on what was written.
+ *
+ * @verbatim
+ * Copyright (c) 2026 Michal Ksiezopolski.
+ * All rights reserved. This program and the
+ * accompanying materials are made available
+ * under the terms of the GNU Public License
+ * v3.0 which accompanies this distribution,
+ * and is available at
+ * http://www.gnu.org/licenses/gpl.html
+ * @endverbatim
+ */
+
+#ifndef STM32F4XX_H_
+#define STM32F4XX_H_
+
+#include <inttypes.h>
+
+typedef enum {RESET = 0, SET = !RESET} FlagStatus, ITStatus;
+typedef enum {DISABLE = 0, ENABLE = !DISABLE} FunctionalState;
+
+typedef enum {
+  USART1_IRQn, USART2_IRQn, USART3_IRQn, USART6_IRQn,
+  DMA1_Stream1_IRQn, DMA1_Stream3_IRQn, DMA1_Stream5_IRQn, DMA1_Stream6_IRQn,
+  DMA2_Stream1_IRQn, DMA2_Stream5_IRQn, DMA2_Stream6_IRQn, DMA2_Stream7_IRQn,
+} IRQn_Type;
+
+typedef struct {
+  volatile uint16_t SR;
+  volatile uint16_t DR;
+} USART_TypeDef;
+
+typedef struct {
+  uint32_t dummy;
+} GPIO_TypeDef;
+
+typedef struct {
+  volatile uint32_t CR;
+  volatile uint32_t NDTR;
+  volatile uint32_t PAR;
+  volatile uint32_t M0AR;
+  volatile uint32_t ISR;  ///< Interrupt flags of the stream (LISR/HISR on the MCU)
+} DMA_Stream_TypeDef;
+
+typedef struct {
+  uint32_t GPIO_Pin;
+  uint32_t GPIO_Mode;
+  uint32_t GPIO_Speed;
+  uint32_t GPIO_OType;
+  uint32_t GPIO_PuPd;
+} GPIO_InitTypeDef;
+
+typedef struct {
+  uint32_t USART_BaudRate;
+  uint16_t USART_WordLength;
+  uint16_t USART_StopBits;
+  uint16_t USART_Parity;
+  uint16_t USART_Mode;
+  uint16_t USART_HardwareFlowControl;
+} USART_InitTypeDef;
+
+typedef struct {
+  uint32_t DMA_Channel;
+  uint32_t DMA_PeripheralBaseAddr;
+  uint32_t DMA_Memory0BaseAddr;
+  uint32_t DMA_DIR;
+  uint32_t DMA_BufferSize;
+  uint32_t DMA_PeripheralInc;
+  uint32_t DMA_MemoryInc;
+  uint32_t DMA_PeripheralDataSize;
+  uint32_t DMA_MemoryDataSize;
+  uint32_t DMA_Mode;
+  uint32_t DMA_Priority;
+} DMA_InitTypeDef;
+
+typedef struct {
+  volatile uint32_t CTRL;
+  volatile uint32_t LOAD;
+  volatile uint32_t VAL;
+  volatile uint32_t CALIB;
+} SysTick_Type;
+
+typedef struct {
+  volatile uint32_t ICSR;
+  volatile uint32_t SCR;
+} SCB_Type;
+
+typedef struct {
+  uint32_t SYSCLK_Frequency;
+  uint32_t HCLK_Frequency;
+  uint32_t PCLK1_Frequency;
+  uint32_t PCLK2_Frequency;
+} RCC_ClocksTypeDef;
+
+SysTick_Type* stubSysTick(void); ///< Returns SysTick registers (by test)
+SCB_Type*     stubScb(void);     ///< Returns SCB registers (by test)
+void          stubWfe(void);     ///< Waits for an event (by test)
+
+#define SysTick   (stubSysTick())
+#define SCB       (stubScb())
+#define __WFE()   stubWfe()
+#define __DSB()   ((void)0)
+#define __ISB()   ((void)0)
+
+#define SysTick_CTRL_ENABLE_Msk     0x00000001
+#define SysTick_CTRL_TICKINT_Msk    0x00000002
+#define SysTick_CTRL_CLKSOURCE_Msk  0x00000004
+#define SysTick_LOAD_RELOAD_Msk     0x00FFFFFF
+#define SCB_ICSR_PENDSTSET_Msk      0x04000000
+#define SCB_ICSR_PENDSTCLR_Msk      0x02000000
+#define SCB_SCR_SEVONPEND_Msk       0x00000010
+
+extern USART_TypeDef stubUsart[4];
+extern GPIO_TypeDef stubGpio[4];
+extern DMA_Stream_TypeDef stubDma1[8];
+extern DMA_Stream_TypeDef stubDma2[8];
+
+#define USART1        (&stubUsart[0])
+#define USART2        (&stubUsart[1])
+#define USART3        (&stubUsart[2])
+#define USART6        (&stubUsart[3])
+#define GPIOA         (&stubGpio[0])
+#define GPIOB         (&stubGpio[1])
+#define GPIOC         (&stubGpio[2])
+#define GPIOD         (&stubGpio[3])
+#define DMA1_Stream1  (&stubDma1[1])
+#define DMA1_Stream3  (&stubDma1[3])
+#define DMA1_Stream5  (&stubDma1[5])
+#define DMA1_Stream6  (&stubDma1[6])
+#define DMA2_Stream1  (&stubDma2[1])
+#define DMA2_Stream5  (&stubDma2[5])
+#define DMA2_Stream6  (&stubDma2[6])
+#define DMA2_Stream7  (&stubDma2[7])
+
+#define RCC_APB1Periph_USART2   0x00020000
+#define RCC_APB1Periph_USART3   0x00040000
+#define RCC_APB2Periph_USART1   0x00000010
+#define RCC_APB2Periph_USART6   0x00000020
+#define RCC_AHB1Periph_GPIOA    0x00000001
+#define RCC_AHB1Periph_GPIOB    0x00000002
+#define RCC_AHB1Periph_GPIOC    0x00000004
+#define RCC_AHB1Periph_GPIOD    0x00000008
+#define RCC_AHB1Periph_DMA1     0x00200000
+#define RCC_AHB1Periph_DMA2     0x00400000
+
+#define GPIO_Pin_2        0x0004
+#define GPIO_Pin_3        0x0008
+#define GPIO_Pin_6        0x0040
+#define GPIO_Pin_7        0x0080
+#define GPIO_Pin_8        0x0100
+#define GPIO_Pin_9        0x0200
+#define GPIO_PinSource2   2
+#define GPIO_PinSource3   3
+#define GPIO_PinSource6   6
+#define GPIO_PinSource7   7
+#define GPIO_PinSource8   8
+#define GPIO_PinSource9   9
+#define GPIO_AF_USART1    7
+#define GPIO_AF_USART2    7
+#define GPIO_AF_USART3    7
+#define GPIO_AF_USART6    8
+#define GPIO_Mode_AF      2
+#define GPIO_Speed_50MHz  2
+#define GPIO_OType_PP     0
+#define GPIO_PuPd_UP      1
+
+#define USART_WordLength_8b             0x0000
+#define USART_StopBits_1                0x0000
+#define USART_Parity_No                 0x0000
+#define USART_HardwareFlowControl_None  0x0000
+#define USART_Mode_Rx                   0x0004
+#define USART_Mode_Tx                   0x0008
+#define USART_IT_PE                     0x0028
+#define USART_IT_TXE                    0x0727
+#define USART_IT_RXNE                   0x0525
+#define USART_IT_IDLE                   0x0424
+#define USART_IT_ERR                    0x0060
+#define USART_FLAG_PE                   0x0001
+#define USART_FLAG_FE                   0x0002
+#define USART_FLAG_NE                   0x0004
+#define USART_FLAG_ORE                  0x0008
+#define USART_DMAReq_Tx                 0x0080
+#define USART_DMAReq_Rx                 0x0040
+
+#define DMA_Channel_4                   0x08000000
+#define DMA_Channel_5                   0x0A000000
+#define DMA_DIR_PeripheralToMemory      0x00000000
+#define DMA_DIR_MemoryToPeripheral      0x00000040
+#define DMA_PeripheralInc_Disable       0x00000000
+#define DMA_MemoryInc_Enable            0x00000400
+#define DMA_PeripheralDataSize_Byte     0x00000000
+#define DMA_MemoryDataSize_Byte         0x00000000
+#define DMA_Mode_Normal                 0x00000000
+#define DMA_Mode_Circular               0x00000100
+#define DMA_Priority_Low                0x00000000
+#define DMA_Priority_High               0x00020000
+#define DMA_IT_TC                       0x00000010
+#define DMA_IT_HT                       0x00000008
+#define DMA_SxCR_EN                     0x00000001
+
+// flags are kept per stream, so all streams use the same bits
+#define DMA_FLAG_FEIF   0x01
+#define DMA_FLAG_DMEIF  0x04
+#define DMA_FLAG_TEIF   0x08
+#define DMA_FLAG_HTIF   0x10
+#define DMA_FLAG_TCIF   0x20
+#define DMA_FLAG_FEIF3  DMA_FLAG_FEIF
+#define DMA_FLAG_DMEIF3 DMA_FLAG_DMEIF
+#define DMA_FLAG_TEIF3  DMA_FLAG_TEIF
+#define DMA_FLAG_HTIF3  DMA_FLAG_HTIF
+#define DMA_FLAG_TCIF3  DMA_FLAG_TCIF
+#define DMA_FLAG_FEIF6  DMA_FLAG_FEIF
+#define DMA_FLAG_DMEIF6 DMA_FLAG_DMEIF
+#define DMA_FLAG_TEIF6  DMA_FLAG_TEIF
+#define DMA_FLAG_HTIF6  DMA_FLAG_HTIF
+#define DMA_FLAG_TCIF6  DMA_FLAG_TCIF
+#define DMA_FLAG_FEIF7  DMA_FLAG_FEIF
+#define DMA_FLAG_DMEIF7 DMA_FLAG_DMEIF
+#define DMA_FLAG_TEIF7  DMA_FLAG_TEIF
+#define DMA_FLAG_HTIF7  DMA_FLAG_HTIF
+#define DMA_FLAG_TCIF7  DMA_FLAG_TCIF
+#define DMA_IT_HTIF1    DMA_FLAG_HTIF
+#define DMA_IT_HTIF5    DMA_FLAG_HTIF
+#define DMA_IT_TCIF1    DMA_FLAG_TCIF
+#define DMA_IT_TCIF3    DMA_FLAG_TCIF
+#define DMA_IT_TCIF5    DMA_FLAG_TCIF
+#define DMA_IT_TCIF6    DMA_FLAG_TCIF
+#define DMA_IT_TCIF7    DMA_FLAG_TCIF
+
+static inline void RCC_GetClocksFreq(RCC_ClocksTypeDef* clocks) {
+  clocks->SYSCLK_Frequency = 168000000;
+  clocks->HCLK_Frequency   = 168000000;
+  clocks->PCLK1_Frequency  = 42000000;
+  clocks->PCLK2_Frequency  = 84000000;
+}
+static inline uint32_t SysTick_Config(uint32_t ticks) {
+  SysTick->LOAD = ticks - 1;
+  SysTick->VAL  = 0;
+  SysTick->CTRL = SysTick_CTRL_CLKSOURCE_Msk | SysTick_CTRL_TICKINT_Msk |
+      SysTick_CTRL_ENABLE_Msk;
+  return 0;
+}
+
+static inline void RCC_APB1PeriphClockCmd(uint32_t p, FunctionalState s) { }
+static inline void RCC_APB2PeriphClockCmd(uint32_t p, FunctionalState s) { }
+static inline void RCC_AHB1PeriphClockCmd(uint32_t p, FunctionalState s) { }
+static inline void NVIC_EnableIRQ(IRQn_Type irq) { }
+
+static inline void GPIO_Init(GPIO_TypeDef* gpio, GPIO_InitTypeDef* init) { }
+static inline void GPIO_PinAFConfig(GPIO_TypeDef* gpio, uint16_t src, uint8_t af) { }
+
+static inline void USART_Init(USART_TypeDef* usart, USART_InitTypeDef* init) { }
+static inline void USART_Cmd(USART_TypeDef* usart, FunctionalState s) { }
+static inline void USART_ITConfig(USART_TypeDef* usart, uint16_t it, FunctionalState s) { }
+static inline void USART_DMACmd(USART_TypeDef* usart, uint16_t req, FunctionalState s) { }
+static inline ITStatus USART_GetITStatus(USART_TypeDef* usart, uint16_t it) {
+  return RESET;
+}
+static inline void USART_SendData(USART_TypeDef* usart, uint16_t data) {
+  usart->DR = data;
+}
+static inline uint16_t USART_ReceiveData(USART_TypeDef* usart) {
+  return usart->DR;
+}
+
+static inline void DMA_DeInit(DMA_Stream_TypeDef* stream) {
+  stream->CR = 0;
+  stream->ISR = 0;
+}
+static inline void DMA_StructInit(DMA_InitTypeDef* init) {
+  *init = (DMA_InitTypeDef){ 0 };
+}
+static inline void DMA_Init(DMA_Stream_TypeDef* stream, DMA_InitTypeDef* init) {
+  stream->PAR  = init->DMA_PeripheralBaseAddr;
+  stream->M0AR = init->DMA_Memory0BaseAddr;
+  stream->NDTR = init->DMA_BufferSize;
+}
+static inline void DMA_ITConfig(DMA_Stream_TypeDef* stream, uint32_t it, FunctionalState s) { }
+static inline void DMA_Cmd(DMA_Stream_TypeDef* stream, FunctionalState s) {
+  if (s) {
+    stream->CR |= DMA_SxCR_EN;
+  } else {
+    stream->CR &= ~DMA_SxCR_EN;
+  }
+}
+static inline uint16_t DMA_GetCurrDataCounter(DMA_Stream_TypeDef* stream) {
+  return stream->NDTR;
+}
+static inline void DMA_ClearFlag(DMA_Stream_TypeDef* stream, uint32_t flags) {
+  stream->ISR &= ~flags;
+}
+static inline ITStatus DMA_GetITStatus(DMA_Stream_TypeDef* stream, uint32_t it) {
+  return (stream->ISR & it) ? SET : RESET;
+}
+static inline void DMA_ClearITPendingBit(DMA_Stream_TypeDef* stream, uint32_t it) {
+  stream->ISR &= ~it;
+}
+
+#endif /* STM32F4XX_H_ */
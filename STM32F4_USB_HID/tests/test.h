@@ -0,0 +1,65 @@
+/**
+ * @file    test.h
+ * @brief   Checks used by the host tests
+ * @date    17 paź 2026
+ * @author  Michal Ksiezopolski
+ *
+ * @details Every test is a separate program. Failed checks are
+ * printed and counted, TEST_Result prints the summary and gives
+ * the exit code for make.
+ *
+ * @verbatim
+ * Copyright (c) 2026 Michal Ksiezopolski.
+ * All rights reserved. This program and the
+ * accompanying materials are made available
+ * under the terms of the GNU Public License
+ * v3.0 which accompanies this distribution,
+ * and is available at
+ * http://www.gnu.org/licenses/gpl.html
+ * @endverbatim
+ */
+
+#ifndef TEST_H_
+#define TEST_H_
+
+#include <stdio.h>
+#include <time.h>
+
+static unsigned testFailures; ///< Number of failed checks
+
+/**
+ * @brief Checks a condition and reports it if false.
+ */
+#define TEST_CHECK(cond) do {                                   \
+  if (!(cond)) {                                                \
+    printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+    testFailures++;                                             \
+  }                                                             \
+} while (0)
+
+/**
+ * @brief Returns the time in seconds (for benchmarks).
+ */
+static inline double TEST_Seconds(void) {
+
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+/**
+ * @brief Prints the summary of a test.
+ * @param name Test name
+ * @return Exit code (0 - all checks passed)
+ */
+static inline int TEST_Result(const char* name) {
+
+  if (testFailures) {
+    printf("%s: %u checks FAILED\n", name, testFailures);
+    return 1;
+  }
+  printf("%s: OK\n", name);
+  return 0;
+}
+
+#endif /* TEST_H_ */
@@ -0,0 +1,156 @@
+/**
+ * @file    test_cmd.c
+ * @brief   Command dispatcher tests and benchmark
+ * @date    17 paź 2026
+ * @author  Michal Ksiezopolski
+ *
+ * @details Fills the command table, checks that every command and
+ * its arguments reach the right handler and compares the dispatch
+ * time with a linear strcmp search.
+ *
+ * @verbatim
+ * Copyright (c) 2026 Michal Ksiezopolski.
+ * All rights reserved. This program and the
+ * accompanying materials are made available
+ * under the terms of the GNU Public License
+ * v3.0 which accompanies this distribution,
+ * and is available at
+ * http://www.gnu.org/licenses/gpl.html
+ * @endverbatim
+ */
+
+#include <test.h>
+#include <cmd.h>
+#include <string.h>
+
+#define BENCH_ROUNDS 20000 ///< Dispatches of every command in the benchmark
+#define FRAME_LEN    32    ///< Size of frame buffers
+
+static char names[CMD_MAX_COMMANDS + 1][12]; ///< Command names
+static const CMD_Token_TypeDef* lastArgv;    ///< Arguments of the last call
+static uint8_t lastArgc;                     ///< Number of arguments of the last call
+static uint32_t calls;                       ///< Number of handler calls
+
+/**
+ * @brief Handler of all commands.
+ */
+static void handler(uint8_t argc, const CMD_Token_TypeDef* argv) {
+  lastArgc = argc;
+  lastArgv = argv;
+  calls++;
+}
+/**
+ * @brief Makes the frame of command number i.
+ * @param buf Frame buffer (FRAME_LEN bytes)
+ * @param i Command number
+ * @return Length of frame
+ */
+static uint16_t makeFrame(char* buf, int i) {
+  return snprintf(buf, FRAME_LEN, "%s %d", names[i], i);
+}
+/**
+ * @brief Registers a full table of commands in a scrambled order.
+ */
+static void testRegister(void) {
+
+  int i;
+
+  for (i = 0; i <= CMD_MAX_COMMANDS; i++) {
+    // similar names with common prefixes make the search work harder
+    sprintf(names[i], ":C%c%03d", 'A' + i % 5, i);
+  }
+
+  for (int k = 0; k < CMD_MAX_COMMANDS; k++) {
+    i = (k * 37) % CMD_MAX_COMMANDS; // 37 is coprime with the table size
+    TEST_CHECK(CMD_Register(names[i], handler, 1, 2) == 0);
+  }
+
+  TEST_CHECK(CMD_Register(names[CMD_MAX_COMMANDS], handler, 1, 2) == 1); // full
+  TEST_CHECK(CMD_Register(names[0], handler, 1, 2) == 1); // duplicate
+}
+/**
+ * @brief Dispatches every command.
+ */
+static void testDispatch(void) {
+
+  char buf[FRAME_LEN];
+  uint16_t len;
+
+  for (int i = 0; i < CMD_MAX_COMMANDS; i++) {
+
+    len = makeFrame(buf, i);
+    lastArgv = NULL;
+    TEST_CHECK(CMD_Dispatch(buf, len) == 0);
+    TEST_CHECK(lastArgc == 1 && lastArgv != NULL);
+    if (lastArgv) {
+      // zero copy - the argument points into the frame
+      TEST_CHECK(lastArgv[0].str == buf + strlen(names[i]) + 1);
+      TEST_CHECK(lastArgv[0].len == len - strlen(names[i]) - 1);
+    }
+  }
+
+  calls = 0;
+  TEST_CHECK(CMD_Dispatch(names[0], strlen(names[0])) == 2); // too few
+  TEST_CHECK(CMD_Dispatch(":CA000 1 2 3", 12) == 2);         // too many
+  TEST_CHECK(CMD_Dispatch("  :CA000   1  2  ", 17) == 0);    // extra spaces
+  TEST_CHECK(lastArgc == 2 && lastArgv[1].len == 1 && lastArgv[1].str[0] == '2');
+  TEST_CHECK(CMD_Dispatch(":CA00 1", 7) == 1);               // prefix
+  TEST_CHECK(CMD_Dispatch(":CA0000 1", 9) == 1);             // longer
+  TEST_CHECK(CMD_Dispatch(names[CMD_MAX_COMMANDS], strlen(names[CMD_MAX_COMMANDS])) == 1);
+  TEST_CHECK(CMD_Dispatch("   ", 3) == 1);                   // empty
+  TEST_CHECK(CMD_Dispatch(":CA000 1", 3) == 1);              // cut name
+  TEST_CHECK(calls == 1);
+}
+/**
+ * @brief Compares the dispatch time with a linear search.
+ */
+static void benchmark(void) {
+
+  static char frames[CMD_MAX_COMMANDS][FRAME_LEN];
+  static uint16_t lens[CMD_MAX_COMMANDS];
+  volatile uint32_t found = 0;
+  double start, tableTime, linearTime;
+  char name[12];
+
+  for (int i = 0; i < CMD_MAX_COMMANDS; i++) {
+    lens[i] = makeFrame(frames[i], i);
+  }
+
+  start = TEST_Seconds();
+  for (int r = 0; r < BENCH_ROUNDS; r++) {
+    for (int i = 0; i < CMD_MAX_COMMANDS; i++) {
+      CMD_Dispatch(frames[i], lens[i]);
+    }
+  }
+  tableTime = TEST_Seconds() - start;
+
+  // the old way - copy the name and strcmp every command in turn
+  start = TEST_Seconds();
+  for (int r = 0; r < BENCH_ROUNDS; r++) {
+    for (int i = 0; i < CMD_MAX_COMMANDS; i++) {
+      memcpy(name, frames[i], strlen(names[i]));
+      name[strlen(names[i])] = 0;
+      for (int k = 0; k < CMD_MAX_COMMANDS; k++) {
+        if (strcmp(name, names[k]) == 0) {
+          found++;
+          break;
+        }
+      }
+    }
+  }
+  linearTime = TEST_Seconds() - start;
+
+  printf("bench %u commands: table %.0f ns, linear strcmp %.0f ns per frame\n",
+      (unsigned)CMD_MAX_COMMANDS,
+      tableTime / BENCH_ROUNDS / CMD_MAX_COMMANDS * 1e9,
+      linearTime / BENCH_ROUNDS / CMD_MAX_COMMANDS * 1e9);
+}
+
+int main(void) {
+
+  testRegister();
+  testDispatch();
+  benchmark();
+
+  return TEST_Result("test_cmd");
+}
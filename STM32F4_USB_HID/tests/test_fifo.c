@@ -0,0 +1,346 @@
+/**
+ * @file    test_fifo.c
+ * @brief   FIFO tests and benchmark
+ * @date    17 paź 2026
+ * @author  Michal Ksiezopolski
+ *
+ * @details Checks the FIFO functions, runs a producer and a consumer
+ * thread through one FIFO without any locking and compares the
+ * throughput of the byte and block functions with the count based
+ * FIFO they replaced.
+ *
+ * @verbatim
+ * Copyright (c) 2026 Michal Ksiezopolski.
+ * All rights reserved. This program and the
+ * accompanying materials are made available
+ * under the terms of the GNU Public License
+ * v3.0 which accompanies this distribution,
+ * and is available at
+ * http://www.gnu.org/licenses/gpl.html
+ * @endverbatim
+ */
+
+#include <test.h>
+#include <fifo.h>
+#include <pthread.h>
+#include <sched.h>
+#include <string.h>
+
+#define STRESS_BYTES  (16UL << 20) ///< Bytes sent through the FIFO by the stress test
+#define BENCH_BYTES   (32UL << 20) ///< Bytes sent through the FIFO by the benchmark
+
+/**
+ * @brief Byte number i of the test stream.
+ */
+static inline uint8_t streamByte(uint32_t i) {
+  return (uint8_t)(i * 7 + (i >> 8));
+}
+
+/**
+ * @brief Checks the FIFO functions in a single thread.
+ */
+static void testBasic(void) {
+
+  uint8_t buf[16];
+  uint8_t data[32];
+  uint8_t* span;
+  uint8_t c;
+  FIFO_TypeDef fifo = { .buf = buf, .len = 0 };
+
+  TEST_CHECK(FIFO_Add(&fifo) == 1);
+  fifo.len = 12;
+  TEST_CHECK(FIFO_Add(&fifo) == 1);
+  fifo.len = sizeof(buf);
+  TEST_CHECK(FIFO_Add(&fifo) == 0);
+
+  TEST_CHECK(FIFO_IsEmpty(&fifo));
+  TEST_CHECK(FIFO_Pop(&fifo, &c) == 1);
+
+  for (int i = 0; i < 16; i++) {
+    TEST_CHECK(FIFO_Push(&fifo, i) == 0);
+  }
+  TEST_CHECK(FIFO_Push(&fifo, 16) == 1); // full
+  TEST_CHECK(FIFO_Count(&fifo) == 16);
+
+  for (int i = 0; i < 10; i++) {
+    TEST_CHECK(FIFO_Pop(&fifo, &c) == 0 && c == i);
+  }
+
+  // 6 bytes stored at offset 10 - block push wraps
+  for (int i = 0; i < 32; i++) {
+    data[i] = 100 + i;
+  }
+  TEST_CHECK(FIFO_PushBlock(&fifo, data, 32) == 10); // only part fits
+  TEST_CHECK(FIFO_Count(&fifo) == 16);
+
+  TEST_CHECK(FIFO_Peek(&fifo, &span) == 6); // up to the wrap point
+  TEST_CHECK(span[0] == 10 && span[5] == 15);
+  FIFO_Consume(&fifo, 6);
+
+  TEST_CHECK(FIFO_PopBlock(&fifo, data, 32) == 10);
+  TEST_CHECK(data[0] == 100 && data[9] == 109);
+  TEST_CHECK(FIFO_IsEmpty(&fifo));
+
+#if FIFO_STATS
+  FIFO_Stats_TypeDef stats;
+  FIFO_GetStats(&fifo, &stats);
+  TEST_CHECK(stats.peak == 16);
+  TEST_CHECK(stats.pushes == 26 && stats.pops == 26);
+  TEST_CHECK(stats.drops == 23);
+#endif
+
+  // overwrite policy keeps the newest data
+  fifo.policy = FIFO_POLICY_OVERWRITE;
+  for (int i = 0; i < 20; i++) {
+    TEST_CHECK(FIFO_Push(&fifo, i) == 0);
+  }
+  TEST_CHECK(FIFO_Pop(&fifo, &c) == 0 && c == 4);
+  TEST_CHECK(FIFO_PushBlock(&fifo, data, 32) == 32);
+  TEST_CHECK(FIFO_PopBlock(&fifo, data, 32) == 16 && data[0] == 116);
+}
+
+static FIFO_TypeDef stressFifo; ///< FIFO shared by the threads
+
+/**
+ * @brief Producer thread - mixes all producer functions.
+ */
+static void* stressProducer(void* arg) {
+
+  uint8_t block[100];
+  uint8_t* dst;
+  uint32_t i = 0;
+  uint16_t n;
+
+  (void)arg;
+
+  while (i < STRESS_BYTES) {
+
+    n = 0;
+
+    switch (i % 3) {
+    case 0:
+      n = FIFO_Push(&stressFifo, streamByte(i)) == 0;
+      break;
+    case 1:
+      n = 1 + i % sizeof(block);
+      if (n > STRESS_BYTES - i) {
+        n = STRESS_BYTES - i;
+      }
+      for (uint16_t k = 0; k < n; k++) {
+        block[k] = streamByte(i + k);
+      }
+      n = FIFO_PushBlock(&stressFifo, block, n);
+      break;
+    case 2:
+      n = STRESS_BYTES - i > 0xFFFF ? 0xFFFF : STRESS_BYTES - i;
+      n = FIFO_Reserve(&stressFifo, n, &dst);
+      for (uint16_t k = 0; k < n; k++) {
+        dst[k] = streamByte(i + k);
+      }
+      FIFO_Commit(&stressFifo, n);
+      break;
+    }
+
+    i += n;
+    if (n == 0) {
+      sched_yield(); // full - let the consumer run
+    }
+  }
+
+  return NULL;
+}
+/**
+ * @brief Consumer thread - mixes all consumer functions.
+ * @return Number of wrong bytes
+ */
+static void* stressConsumer(void* arg) {
+
+  uint8_t block[64];
+  uint8_t* src;
+  uint32_t i = 0;
+  uint16_t n;
+  uintptr_t errors = 0;
+
+  (void)arg;
+
+  while (i < STRESS_BYTES) {
+
+    switch (i % 3) {
+    case 0:
+      n = FIFO_Pop(&stressFifo, block) == 0;
+      break;
+    case 1:
+      n = FIFO_PopBlock(&stressFifo, block, 1 + i % sizeof(block));
+      break;
+    default:
+      n = FIFO_Peek(&stressFifo, &src);
+      memcpy(block, src, n > sizeof(block) ? sizeof(block) : n);
+      n = n > sizeof(block) ? sizeof(block) : n;
+      FIFO_Consume(&stressFifo, n);
+      break;
+    }
+
+    for (uint16_t k = 0; k < n; k++) {
+      errors += block[k] != streamByte(i + k);
+    }
+
+    i += n;
+    if (n == 0) {
+      sched_yield(); // empty - let the producer run
+    }
+  }
+
+  return (void*)errors;
+}
+/**
+ * @brief Sends a stream through the FIFO from one thread to another.
+ * @param len FIFO length
+ */
+static void testStress(uint16_t len) {
+
+  static uint8_t buf[0x8000];
+  pthread_t producer, consumer;
+  void* errors;
+  double start = TEST_Seconds();
+
+  memset(&stressFifo, 0, sizeof(stressFifo));
+  stressFifo.buf = buf;
+  stressFifo.len = len;
+  TEST_CHECK(FIFO_Add(&stressFifo) == 0);
+
+  pthread_create(&consumer, NULL, stressConsumer, NULL);
+  pthread_create(&producer, NULL, stressProducer, NULL);
+  pthread_join(producer, NULL);
+  pthread_join(consumer, &errors);
+
+  TEST_CHECK(errors == NULL);
+  TEST_CHECK(FIFO_IsEmpty(&stressFifo));
+#if FIFO_STATS
+  TEST_CHECK(stressFifo.stats.pushes == STRESS_BYTES);
+  TEST_CHECK(stressFifo.stats.pops == STRESS_BYTES);
+#endif
+
+  printf("stress %5u: %lu bytes in %.2f s, %lu errors\n", (unsigned)len,
+      STRESS_BYTES, TEST_Seconds() - start, (unsigned long)(uintptr_t)errors);
+}
+/**
+ * @brief Count based FIFO which was used before the lock free one.
+ * @details Kept as the baseline of the benchmark. The count is
+ * changed by both sides, so on the MCU the producer had to disable
+ * the consumer interrupt around every byte (not done here).
+ */
+typedef struct {
+  uint16_t head;   ///< Head
+  uint16_t tail;   ///< Tail
+  uint8_t* buf;    ///< Pointer to buffer
+  uint16_t len;    ///< Maximum length of FIFO
+  uint16_t count;  ///< Current number of data elements
+} OLD_FIFO_TypeDef;
+
+/**
+ * @brief Pushes data to the baseline FIFO (not inlined, like FIFO_Push).
+ */
+static __attribute__((noinline)) uint8_t OLD_FIFO_Push(OLD_FIFO_TypeDef* fifo,
+    uint8_t c) {
+
+  if (fifo->count == fifo->len) {
+    return 1;
+  }
+
+  fifo->buf[fifo->head++] = c;
+  fifo->count++;
+
+  if (fifo->head == fifo->len) {
+    fifo->head = 0;
+  }
+
+  return 0;
+}
+/**
+ * @brief Pops data from the baseline FIFO (not inlined, like FIFO_Pop).
+ */
+static __attribute__((noinline)) uint8_t OLD_FIFO_Pop(OLD_FIFO_TypeDef* fifo,
+    uint8_t* c) {
+
+  if (fifo->count == 0) {
+    return 1;
+  }
+
+  *c = fifo->buf[fifo->tail++];
+  fifo->count--;
+
+  if (fifo->tail == fifo->len) {
+    fifo->tail = 0;
+  }
+
+  return 0;
+}
+/**
+ * @brief Measures the throughput of byte and block transfers.
+ * @param len FIFO length
+ */
+static void benchmark(uint16_t len) {
+
+  static uint8_t buf[0x8000];
+  static uint8_t data[0x8000];
+  FIFO_TypeDef fifo = { .buf = buf, .len = len };
+  OLD_FIFO_TypeDef oldFifo = { .buf = buf, .len = len };
+  uint32_t chunk = len / 2;
+  double start;
+  double oldTime, byteTime, blockTime;
+  volatile uint8_t sink = 0;
+  uint8_t c;
+
+  FIFO_Add(&fifo);
+
+  start = TEST_Seconds();
+  for (uint32_t done = 0; done < BENCH_BYTES; done += chunk) {
+    for (uint32_t k = 0; k < chunk; k++) {
+      OLD_FIFO_Push(&oldFifo, k);
+    }
+    for (uint32_t k = 0; k < chunk; k++) {
+      OLD_FIFO_Pop(&oldFifo, &c);
+      sink += c;
+    }
+  }
+  oldTime = TEST_Seconds() - start;
+
+  start = TEST_Seconds();
+  for (uint32_t done = 0; done < BENCH_BYTES; done += chunk) {
+    for (uint32_t k = 0; k < chunk; k++) {
+      FIFO_Push(&fifo, k);
+    }
+    for (uint32_t k = 0; k < chunk; k++) {
+      FIFO_Pop(&fifo, &c);
+      sink += c;
+    }
+  }
+  byteTime = TEST_Seconds() - start;
+
+  start = TEST_Seconds();
+  for (uint32_t done = 0; done < BENCH_BYTES; done += chunk) {
+    FIFO_PushBlock(&fifo, data, chunk);
+    FIFO_PopBlock(&fifo, data, chunk);
+    sink += data[0];
+  }
+  blockTime = TEST_Seconds() - start;
+
+  printf("bench %5u: old byte %7.1f MB/s, byte %7.1f MB/s, block %7.1f MB/s\n",
+      (unsigned)len, BENCH_BYTES / oldTime / 1e6, BENCH_BYTES / byteTime / 1e6,
+      BENCH_BYTES / blockTime / 1e6);
+}
+
+int main(void) {
+
+  testBasic();
+
+  testStress(16);
+  testStress(1024);
+
+  benchmark(64);
+  benchmark(256);
+  benchmark(1024);
+  benchmark(4096);
+
+  return TEST_Result("test_fifo");
+}
@@ -0,0 +1,226 @@
+/**
+ * @file    test_fifo_typed.c
+ * @brief   Typed FIFO tests
+ * @date    17 paź 2026
+ * @author  Michal Ksiezopolski
+ *
+ * @details Checks a FIFO of structures and sends whole structures
+ * from a producer thread to a consumer thread. The benchmark compares
+ * it with sending the same structures through the byte FIFO. Build
+ * with TEST_BAD_SIZE defined to check that a wrong size doesn't compile.
+ *
+ * @verbatim
+ * Copyright (c) 2026 Michal Ksiezopolski.
+ * All rights reserved. This program and the
+ * accompanying materials are made available
+ * under the terms of the GNU Public License
+ * v3.0 which accompanies this distribution,
+ * and is available at
+ * http://www.gnu.org/licenses/gpl.html
+ * @endverbatim
+ */
+
+#include <test.h>
+#include <fifo_typed.h>
+#include <fifo.h>
+#include <pthread.h>
+#include <sched.h>
+
+#define STRESS_REPORTS 4000000 ///< Reports sent by the stress test
+#define BENCH_REPORTS  (8UL << 20) ///< Reports sent by the benchmark
+#define BENCH_BATCH    32      ///< Reports pushed before popping them
+
+/**
+ * @brief Element bigger than a machine word, so a torn copy shows.
+ */
+typedef struct {
+  uint32_t seq;     ///< Sequence number
+  int8_t   x, y;    ///< Same as seq
+  uint16_t check;   ///< ~seq
+} TEST_Report_TypeDef;
+
+FIFO_TYPED_DEFINE(REPORTS, TEST_Report_TypeDef, 8)
+FIFO_TYPED_DEFINE(BENCH, TEST_Report_TypeDef, 64)
+
+#ifdef TEST_BAD_SIZE
+FIFO_TYPED_DEFINE(BAD, uint8_t, TEST_BAD_SIZE)
+#endif
+
+/**
+ * @brief Makes report number seq.
+ */
+static TEST_Report_TypeDef makeReport(uint32_t seq) {
+
+  TEST_Report_TypeDef r = { seq, (int8_t)seq, (int8_t)(seq >> 8), (uint16_t)~seq };
+
+  return r;
+}
+/**
+ * @brief Checks if report r is report number seq.
+ */
+static int reportOk(const TEST_Report_TypeDef* r, uint32_t seq) {
+  return r->seq == seq && r->x == (int8_t)seq && r->y == (int8_t)(seq >> 8) &&
+      r->check == (uint16_t)~seq;
+}
+/**
+ * @brief Checks the typed FIFO functions in a single thread.
+ */
+static void testBasic(void) {
+
+  REPORTS_TypeDef fifo;
+  TEST_Report_TypeDef r;
+
+  REPORTS_Init(&fifo);
+  TEST_CHECK(REPORTS_IsEmpty(&fifo));
+  TEST_CHECK(REPORTS_Front(&fifo) == NULL);
+  TEST_CHECK(REPORTS_Pop(&fifo, &r) == 1);
+
+  // go around the 16 bit indices a few times
+  for (uint32_t round = 0; round < 30000; round++) {
+
+    for (uint32_t i = 0; i < 5; i++) {
+      r = makeReport(round * 5 + i);
+      TEST_CHECK(REPORTS_Push(&fifo, &r) == 0);
+    }
+    TEST_CHECK(REPORTS_Count(&fifo) == 5);
+    TEST_CHECK(reportOk(REPORTS_Front(&fifo), round * 5));
+
+    for (uint32_t i = 0; i < 5; i++) {
+      TEST_CHECK(REPORTS_Pop(&fifo, &r) == 0 && reportOk(&r, round * 5 + i));
+    }
+  }
+
+  for (uint32_t i = 0; i < 8; i++) {
+    r = makeReport(i);
+    TEST_CHECK(REPORTS_Push(&fifo, &r) == 0);
+  }
+  TEST_CHECK(REPORTS_Push(&fifo, &r) == 1); // full
+  TEST_CHECK(REPORTS_Pop(&fifo, NULL) == 0); // drop without copying
+  TEST_CHECK(REPORTS_Count(&fifo) == 7);
+  TEST_CHECK(reportOk(REPORTS_Front(&fifo), 1));
+}
+
+static REPORTS_TypeDef stressFifo; ///< FIFO shared by the threads
+
+/**
+ * @brief Producer thread.
+ */
+static void* stressProducer(void* arg) {
+
+  TEST_Report_TypeDef r;
+
+  (void)arg;
+
+  for (uint32_t i = 0; i < STRESS_REPORTS; i++) {
+    r = makeReport(i);
+    while (REPORTS_Push(&stressFifo, &r)) {
+      sched_yield(); // full - let the consumer run
+    }
+  }
+
+  return NULL;
+}
+/**
+ * @brief Sends reports from one thread to another.
+ */
+static void testStress(void) {
+
+  pthread_t producer;
+  TEST_Report_TypeDef r;
+  uint32_t errors = 0;
+
+  REPORTS_Init(&stressFifo);
+  pthread_create(&producer, NULL, stressProducer, NULL);
+
+  for (uint32_t i = 0; i < STRESS_REPORTS; i++) {
+    while (REPORTS_Pop(&stressFifo, &r)) {
+      sched_yield(); // empty - let the producer run
+    }
+    errors += !reportOk(&r, i);
+  }
+
+  pthread_join(producer, NULL);
+
+  TEST_CHECK(errors == 0);
+  TEST_CHECK(REPORTS_IsEmpty(&stressFifo));
+}
+
+/**
+ * @brief Measures the throughput of the typed and the byte FIFO.
+ * @details The byte FIFO gets each report as a block and as single
+ * bytes (how reports went through it before the typed FIFO).
+ */
+static void benchmark(void) {
+
+  static BENCH_TypeDef typed;
+  static uint8_t buf[1024]; // holds BENCH_BATCH reports
+  FIFO_TypeDef bytes = { .buf = buf, .len = sizeof(buf) };
+  TEST_Report_TypeDef r;
+  uint8_t* p;
+  uint32_t errors = 0;
+  double start;
+  double typedTime, blockTime, byteTime;
+
+  BENCH_Init(&typed);
+  FIFO_Add(&bytes);
+
+  start = TEST_Seconds();
+  for (uint32_t done = 0; done < BENCH_REPORTS; done += BENCH_BATCH) {
+    for (uint32_t k = 0; k < BENCH_BATCH; k++) {
+      r = makeReport(done + k);
+      BENCH_Push(&typed, &r);
+    }
+    for (uint32_t k = 0; k < BENCH_BATCH; k++) {
+      BENCH_Pop(&typed, &r);
+      errors += r.seq != done + k;
+    }
+  }
+  typedTime = TEST_Seconds() - start;
+
+  start = TEST_Seconds();
+  for (uint32_t done = 0; done < BENCH_REPORTS; done += BENCH_BATCH) {
+    for (uint32_t k = 0; k < BENCH_BATCH; k++) {
+      r = makeReport(done + k);
+      FIFO_PushBlock(&bytes, (uint8_t*)&r, sizeof(r));
+    }
+    for (uint32_t k = 0; k < BENCH_BATCH; k++) {
+      FIFO_PopBlock(&bytes, (uint8_t*)&r, sizeof(r));
+      errors += r.seq != done + k;
+    }
+  }
+  blockTime = TEST_Seconds() - start;
+
+  start = TEST_Seconds();
+  for (uint32_t done = 0; done < BENCH_REPORTS; done += BENCH_BATCH) {
+    for (uint32_t k = 0; k < BENCH_BATCH; k++) {
+      r = makeReport(done + k);
+      p = (uint8_t*)&r;
+      for (uint32_t i = 0; i < sizeof(r); i++) {
+        FIFO_Push(&bytes, p[i]);
+      }
+    }
+    for (uint32_t k = 0; k < BENCH_BATCH; k++) {
+      p = (uint8_t*)&r;
+      for (uint32_t i = 0; i < sizeof(r); i++) {
+        FIFO_Pop(&bytes, &p[i]);
+      }
+      errors += r.seq != done + k;
+    }
+  }
+  byteTime = TEST_Seconds() - start;
+
+  TEST_CHECK(errors == 0);
+
+  printf("bench %u-byte reports: typed %6.1f M/s, block %6.1f M/s, byte %6.1f M/s\n",
+      (unsigned)sizeof(r), BENCH_REPORTS / typedTime / 1e6,
+      BENCH_REPORTS / blockTime / 1e6, BENCH_REPORTS / byteTime / 1e6);
+}
+
+int main(void) {
+
+  testBasic();
+  testStress();
+  benchmark();
+
+  return TEST_Result("test_fifo_typed");
+}
@@ -0,0 +1,183 @@
+/**
+ * @file    test_format.c
+ * @brief   Formatter conformance tests and benchmark
+ * @date    17 paź 2026
+ * @author  Michal Ksiezopolski
+ *
+ * @details Compares the output of FORMAT_Snprintf with the C library
+ * snprintf for all supported conversions and measures the time of a
+ * typical log line.
+ *
+ * @verbatim
+ * Copyright (c) 2026 Michal Ksiezopolski.
+ * All rights reserved. This program and the
+ * accompanying materials are made available
+ * under the terms of the GNU Public License
+ * v3.0 which accompanies this distribution,
+ * and is available at
+ * http://www.gnu.org/licenses/gpl.html
+ * @endverbatim
+ */
+
+#include <test.h>
+#include <format.h>
+#include <limits.h>
+#include <string.h>
+
+#define BENCH_LINES 2000000 ///< Lines formatted by the benchmark
+
+/**
+ * @brief Formats with both formatters and compares the results.
+ * @param line Line of the test case
+ * @param size Buffer size given to both formatters
+ * @param fmt Format string
+ */
+static void __attribute__((format(printf, 3, 4)))
+checkFormat(int line, uint16_t size, const char* fmt, ...) {
+
+  char ours[128];
+  char ref[128];
+  va_list args, copy;
+
+  memset(ours, 'x', sizeof(ours));
+  memset(ref, 'x', sizeof(ref));
+
+  va_start(args, fmt);
+  va_copy(copy, args);
+  FORMAT_Vsnprintf(ours, size, fmt, args);
+  vsnprintf(ref, size, fmt, copy);
+  va_end(copy);
+  va_end(args);
+
+  if (memcmp(ours, ref, sizeof(ours)) != 0) {
+    printf("%s:%d: \"%s\" gives \"%s\", expected \"%s\"\n", __FILE__, line,
+        fmt, ours, ref);
+    testFailures++;
+  }
+}
+
+#define CHECK(fmt, args...) checkFormat(__LINE__, 128, fmt, ##args)
+#define CHECK_SIZE(size, fmt, args...) checkFormat(__LINE__, size, fmt, ##args)
+
+/**
+ * @brief Checks all supported conversions against snprintf.
+ */
+static void testConformance(void) {
+
+  CHECK("plain text");
+  CHECK("100%%");
+
+  CHECK("%d %d %d", 0, 42, -42);
+  CHECK("%d %d", INT_MAX, INT_MIN);
+  CHECK("%i %ld", -7, 123456789L);
+  CHECK("[%5d] [%-5d] [%05d]", 42, 42, 42);
+  CHECK("[%5d] [%-5d] [%05d]", -42, -42, -42);
+  CHECK("[%1d] [%02d] [%03d]", -123, -123, -123);
+  CHECK("[%*d] [%*d] [%0*d]", 6, 1, -6, 2, 4, 3);
+  CHECK("[%012d]", INT_MIN);
+
+  CHECK("%u %u %u", 0u, 4000000000u, UINT_MAX);
+  CHECK("[%8u] [%-8u] [%08u]", 123u, 123u, 123u);
+  CHECK("%lu", 99ul);
+
+  CHECK("%x %x %X", 0u, 0xdeadbeefu, 0xdeadbeefu);
+  CHECK("[%8x] [%-8X] [%08x] [%02X]", 0xabu, 0xabu, 0xabu, 0x5u);
+  CHECK("%lx", 0x12345678ul);
+
+  CHECK("[%c] [%3c] [%-3c]", 'a', 'b', 'c');
+  CHECK("[%s] [%8s] [%-8s] [%2s]", "abc", "abc", "abc", "abcdef");
+  CHECK("[%s]", "");
+  CHECK("[%*s]", -5, "ab");
+
+  CHECK("%s--> %-8s prio %u runs %u max %u us load %u.%u%%",
+      "SCHED", "CONSOLE", 3u, 1000u, 250u, 12u, 5u);
+
+  // truncated output is still terminated
+  CHECK_SIZE(1, "abc");
+  CHECK_SIZE(5, "%d", 123456);
+  CHECK_SIZE(8, "%s %s", "hello", "world");
+  CHECK_SIZE(6, "[%8d]", -5);
+}
+/**
+ * @brief Refill function giving 4 byte chunks of a buffer.
+ */
+static uint8_t refill(FORMAT_Sink_TypeDef* sink) {
+
+  uint16_t* left = sink->ctx;
+
+  if (*left == 0) {
+    return 1;
+  }
+  sink->room = *left < 4 ? *left : 4;
+  *left -= sink->room;
+  return 0;
+}
+/**
+ * @brief Formats via FORMAT_Vprint.
+ */
+static uint16_t print(FORMAT_Sink_TypeDef* sink, const char* fmt, ...) {
+
+  va_list args;
+  uint16_t n;
+
+  va_start(args, fmt);
+  n = FORMAT_Vprint(sink, fmt, args);
+  va_end(args);
+
+  return n;
+}
+/**
+ * @brief Checks output to a sink refilled in parts.
+ */
+static void testSink(void) {
+
+  char buf[32] = { 0 };
+  uint16_t left = 10; // two chunks of 4 and one of 2
+  FORMAT_Sink_TypeDef sink = {
+    .start = buf, .buf = buf, .room = 0, .ctx = &left, .refill = refill,
+  };
+
+  TEST_CHECK(print(&sink, "%s-%04d", "abcdef", 12) == 10);
+  TEST_CHECK(memcmp(buf, "abcdef-001", 10) == 0);
+  TEST_CHECK(sink.dropped == 1);
+
+  sink.room = 0;
+  sink.refill = NULL;
+  TEST_CHECK(print(&sink, "%u", 5u) == 10);
+  TEST_CHECK(sink.dropped == 2);
+}
+/**
+ * @brief Compares the time of a log line with vsnprintf.
+ */
+static void benchmark(void) {
+
+  char buf[128];
+  volatile uint32_t sum = 0;
+  double start, ourTime, refTime;
+
+  start = TEST_Seconds();
+  for (uint32_t i = 0; i < BENCH_LINES; i++) {
+    sum += FORMAT_Snprintf(buf, sizeof(buf), "%s--> frame %5u from %s: %08x %d\r\n",
+        "COMM", (unsigned)i, "UART2", (unsigned)(i * 2654435761u), -(int)i);
+  }
+  ourTime = TEST_Seconds() - start;
+
+  start = TEST_Seconds();
+  for (uint32_t i = 0; i < BENCH_LINES; i++) {
+    sum += snprintf(buf, sizeof(buf), "%s--> frame %5u from %s: %08x %d\r\n",
+        "COMM", (unsigned)i, "UART2", (unsigned)(i * 2654435761u), -(int)i);
+  }
+  refTime = TEST_Seconds() - start;
+
+  printf("bench log line: FORMAT %.0f ns, snprintf %.0f ns\n",
+      ourTime / BENCH_LINES * 1e9, refTime / BENCH_LINES * 1e9);
+}
+
+int main(void) {
+
+  testConformance();
+  testSink();
+  benchmark();
+
+  return TEST_Result("test_format");
+}
@@ -0,0 +1,276 @@
+/**
+ * @file    test_log.c
+ * @brief   Log router tests
+ * @date    17 paź 2026
+ * @author  Michal Ksiezopolski
+ *
+ * @details Registers a mock sink next to the built in ones and checks
+ * level and module filtering, drop counting, the RAM ring and rate
+ * limiting. The terminal is a fake COMM writing to a buffer.
+ *
+ * @verbatim
+ * Copyright (c) 2026 Michal Ksiezopolski.
+ * All rights reserved. This program and the
+ * accompanying materials are made available
+ * under the terms of the GNU Public License
+ * v3.0 which accompanies this distribution,
+ * and is available at
+ * http://www.gnu.org/licenses/gpl.html
+ * @endverbatim
+ */
+
+#include <test.h>
+#include <hal_stubs.h>
+#include <comm.h>
+#include <cmd.h>
+#include <format.h>
+#include <string.h>
+
+#define LOG_MODULE LOG_KEYS ///< Module of LOG_LIMITED messages
+#include <log.h>
+
+static char commOut[4096];        ///< Terminal output
+static uint16_t commLen;          ///< Length of terminal output
+static uint16_t commFree = 0xFFFF; ///< Free space reported by COMM_TxFree
+
+uint16_t COMM_TxFree(void) {
+  return commFree;
+}
+
+uint16_t COMM_Write(const uint8_t* data, uint16_t len) {
+
+  if (len > sizeof(commOut) - 1 - commLen) {
+    len = sizeof(commOut) - 1 - commLen;
+  }
+  memcpy(&commOut[commLen], data, len);
+  commLen += len;
+  commOut[commLen] = 0;
+
+  return len;
+}
+
+uint16_t COMM_Printf(const char* fmt, ...) {
+
+  va_list args;
+  uint16_t n;
+
+  va_start(args, fmt);
+  n = FORMAT_Vsnprintf(&commOut[commLen], sizeof(commOut) - commLen, fmt, args);
+  va_end(args);
+  commLen += n;
+
+  return n;
+}
+
+static char mockOut[1024];  ///< Messages taken by the mock sink
+static uint16_t mockLen;    ///< Length of mock sink messages
+static uint8_t mockFull;    ///< Nonzero makes the mock sink drop messages
+
+/**
+ * @brief Write function of the mock sink.
+ */
+static uint16_t mockWrite(const uint8_t* data, uint16_t len) {
+
+  if (mockFull || len > sizeof(mockOut) - 1 - mockLen) {
+    return 0;
+  }
+  memcpy(&mockOut[mockLen], data, len);
+  mockLen += len;
+  mockOut[mockLen] = 0;
+
+  return len;
+}
+
+/**
+ * @brief Sink taking warnings and errors of COMM and FIFO.
+ */
+static LOG_Sink_TypeDef mockSink = {
+  "MOCK", LOG_WARN, (1UL << LOG_COMM) | (1UL << LOG_FIFO), mockWrite, 0,
+};
+
+/**
+ * @brief Clears the outputs.
+ */
+static void clear(void) {
+  commLen = 0;
+  commOut[0] = 0;
+  mockLen = 0;
+  mockOut[0] = 0;
+}
+/**
+ * @brief Runs a command.
+ */
+static uint8_t dispatch(const char* frame) {
+  return CMD_Dispatch(frame, strlen(frame));
+}
+/**
+ * @brief Checks that the terminal gets messages before LOG_Init.
+ */
+static void testEarly(void) {
+
+  commFree = 0; // COMM not initialized yet
+  LOG(LOG_COMM, LOG_ERROR, "lost");
+  TEST_CHECK(commLen == 0);
+
+  commFree = 0xFFFF;
+  LOG(LOG_MAIN, LOG_INFO, "Starting %s", "program");
+  TEST_CHECK(strcmp(commOut, "MAIN--> Starting program\r\n") == 0);
+}
+/**
+ * @brief Checks level and module filtering.
+ */
+static void testFilter(void) {
+
+  LOG_Init();
+
+  TEST_CHECK(LOG_AddSink(&mockSink) == 0);
+  TEST_CHECK(LOG_AddSink(&mockSink) == 1); // LOG_MAX_SINKS reached
+
+  clear();
+  LOG(LOG_COMM, LOG_ERROR, "error %d", 1);
+  TEST_CHECK(strcmp(mockOut, "COMM--> error 1\r\n") == 0);
+  TEST_CHECK(strcmp(commOut, "COMM--> error 1\r\n") == 0);
+
+  clear();
+  LOG(LOG_COMM, LOG_INFO, "info");    // above sink level
+  LOG(LOG_MAIN, LOG_ERROR, "main");   // module not in sink mask
+  LOG(LOG_FIFO, LOG_WARN, "fifo");
+  TEST_CHECK(strcmp(mockOut, "FIFO--> fifo\r\n") == 0);
+  TEST_CHECK(strcmp(commOut, "COMM--> info\r\nMAIN--> main\r\nFIFO--> fifo\r\n") == 0);
+
+  // module level is checked before any sink
+  clear();
+  LOG_SetLevel(LOG_COMM, LOG_ERROR);
+  LOG(LOG_COMM, LOG_WARN, "warning");
+  TEST_CHECK(commLen == 0 && mockLen == 0);
+
+  // levels changed with the :LOG command
+  TEST_CHECK(dispatch(":LOG SINK MOCK DEBUG") == 0);
+  TEST_CHECK(dispatch(":LOG FIFO 4") == 0);
+  clear();
+  LOG(LOG_FIFO, LOG_DEBUG, "debug");
+  TEST_CHECK(strcmp(mockOut, "FIFO--> debug\r\n") == 0);
+
+  TEST_CHECK(dispatch(":LOG ALL INFO") == 0);
+  TEST_CHECK(dispatch(":LOG SINK MOCK WARN") == 0);
+  clear();
+  LOG(LOG_FIFO, LOG_DEBUG, "debug");
+  TEST_CHECK(commLen == 0 && mockLen == 0);
+
+  // too long messages are cut, but still end with a new line
+  clear();
+  LOG(LOG_MAIN, LOG_INFO, "%-200s", "x");
+  TEST_CHECK(commLen == LOG_LINE_LEN - 1);
+  TEST_CHECK(strncmp(commOut, "MAIN--> x ", 10) == 0);
+  TEST_CHECK(strcmp(&commOut[commLen - 3], " \r\n") == 0);
+}
+/**
+ * @brief Logs a message like an interrupt during an ITM write.
+ */
+static void itmInterrupt(void) {
+  LOG(LOG_KEYS, LOG_ERROR, "irq");
+}
+/**
+ * @brief Checks drop counting of the sinks.
+ */
+static void testDrops(void) {
+
+  char expected[64];
+  uint32_t itmBytes = stubItmBytes;
+
+  mockFull = 1;
+  for (int i = 0; i < 3; i++) {
+    LOG(LOG_COMM, LOG_ERROR, "dropped");
+  }
+  mockFull = 0;
+  TEST_CHECK(mockSink.drops == 3);
+
+  commFree = 10; // messages are never cut
+  clear();
+  LOG(LOG_MAIN, LOG_INFO, "too long for COMM");
+  TEST_CHECK(commLen == 0);
+  commFree = 0xFFFF;
+
+  // ITM takes everything
+  TEST_CHECK(stubItmBytes - itmBytes == 3 * strlen("COMM--> dropped\r\n") +
+      strlen("MAIN--> too long for COMM\r\n"));
+
+  // a message from an interrupt doesn't go inside the one being written
+  itmBytes = stubItmBytes;
+  stubItmHook = itmInterrupt;
+  clear();
+  LOG(LOG_MAIN, LOG_INFO, "main");
+  TEST_CHECK(stubItmHook == NULL);
+  TEST_CHECK(stubItmBytes - itmBytes == strlen("MAIN--> main\r\n"));
+  TEST_CHECK(strstr(commOut, "KEYS--> irq\r\n") != NULL); // other sinks get it
+
+  clear();
+  TEST_CHECK(dispatch(":LOG") == 0);
+  snprintf(expected, sizeof(expected), "LOG--> Sink %-8s %-5s drops %u\r\n",
+      "UART", "DEBUG", 2); // one before COMM_Init, one now
+  TEST_CHECK(strstr(commOut, expected) != NULL);
+  snprintf(expected, sizeof(expected), "LOG--> Sink %-8s %-5s drops %u\r\n",
+      "MOCK", "WARN", 3);
+  TEST_CHECK(strstr(commOut, expected) != NULL);
+  snprintf(expected, sizeof(expected), "LOG--> Sink %-8s %-5s drops %u\r\n",
+      "ITM", "DEBUG", 1);
+  TEST_CHECK(strstr(commOut, expected) != NULL);
+}
+/**
+ * @brief Checks that the RAM ring keeps the newest warnings.
+ */
+static void testRam(void) {
+
+  static char expected[2048];
+  uint16_t len = 0;
+  const char* header = "LOG--> RAM ring (1024 bytes):\r\n";
+
+  for (int i = 0; i < 100; i++) {
+    LOG(LOG_MAIN, LOG_WARN, "ram %03d", i);
+    len += snprintf(&expected[len], sizeof(expected) - len, "MAIN--> ram %03d\r\n", i);
+  }
+  LOG(LOG_MAIN, LOG_INFO, "not in ram"); // below RAM sink level
+
+  clear();
+  TEST_CHECK(dispatch(":LOG DUMP") == 0);
+  TEST_CHECK(strncmp(commOut, header, strlen(header)) == 0);
+  TEST_CHECK(commLen == strlen(header) + 1024);
+  TEST_CHECK(memcmp(&commOut[strlen(header)], &expected[len - 1024], 1024) == 0);
+}
+/**
+ * @brief One rate limited call site.
+ */
+static void limited(void) {
+  LOG_LIMITED(LOG_WARN, 1000, "limited");
+}
+/**
+ * @brief Checks rate limiting.
+ */
+static void testLimited(void) {
+
+  clear();
+  for (int i = 0; i < 10; i++) {
+    limited();
+  }
+  TEST_CHECK(strcmp(commOut, "KEYS--> limited\r\n") == 0);
+
+  clear();
+  stubTime += 1000; // deadline not reached yet
+  limited();
+  TEST_CHECK(commLen == 0);
+
+  stubTime += 1;
+  limited();
+  TEST_CHECK(strcmp(commOut, "KEYS--> 10 messages suppressed\r\nKEYS--> limited\r\n") == 0);
+}
+
+int main(void) {
+
+  testEarly();
+  testFilter();
+  testDrops();
+  testRam();
+  testLimited();
+
+  return TEST_Result("test_log");
+}
@@ -0,0 +1,168 @@
+/**
+ * @file    test_proto.c
+ * @brief   Binary protocol device for the pty loopback test
+ * @date    17 paź 2026
+ * @author  Michal Ksiezopolski
+ *
+ * @details Runs PROTO with the request handler of main.c on the
+ * master side of a pseudo terminal. The name of the slave side is
+ * printed on stdout - test_proto.py talks to it with
+ * tools/proto_host.py. Exits when stdin is closed.
+ *
+ * @verbatim
+ * Copyright (c) 2026 Michal Ksiezopolski.
+ * All rights reserved. This program and the
+ * accompanying materials are made available
+ * under the terms of the GNU Public License
+ * v3.0 which accompanies this distribution,
+ * and is available at
+ * http://www.gnu.org/licenses/gpl.html
+ * @endverbatim
+ */
+
+#define _GNU_SOURCE // posix_openpt, cfmakeraw
+
+#include <proto.h>
+#include <comm.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <unistd.h>
+
+static int pty;                   ///< Master side of the pty
+static uint8_t rxBuf[1024];       ///< Received bytes not split into frames yet
+static uint16_t rxLen;            ///< Number of bytes in rxBuf
+static uint8_t terminator;        ///< Frame terminator of the PROTO port
+static uint16_t txFree = 1024;    ///< Free space reported by COMM_PortTxFree
+static uint8_t leds[10];          ///< LED states
+
+void COMM_Add(COMM_TypeDef* comm) {
+  terminator = comm->terminator;
+}
+
+uint8_t COMM_PortGetFrame(COMM_TypeDef* comm, uint8_t* buf, uint16_t* len,
+    uint16_t maxLen) {
+
+  uint8_t* end;
+  uint16_t n;
+  ssize_t got;
+
+  *len = 0;
+
+  got = read(pty, &rxBuf[rxLen], sizeof(rxBuf) - rxLen);
+  if (got > 0) {
+    rxLen += got;
+  }
+
+  end = memchr(rxBuf, terminator, rxLen);
+  if (end == NULL) {
+    if (rxLen == sizeof(rxBuf)) { // overrun
+      rxLen = 0;
+      return 2;
+    }
+    return 1;
+  }
+
+  n = end - rxBuf;
+  if (n < maxLen) {
+    memcpy(buf, rxBuf, n);
+    buf[n] = 0;
+    *len = n;
+  }
+  memmove(rxBuf, end + 1, rxLen - n - 1);
+  rxLen -= n + 1;
+
+  return n < maxLen ? 0 : 2;
+}
+
+uint16_t COMM_PortTxFree(COMM_TypeDef* comm) {
+  return txFree;
+}
+
+uint16_t COMM_PortWrite(COMM_TypeDef* comm, const uint8_t* data, uint16_t len) {
+  return write(pty, data, len) == len ? len : 0;
+}
+
+/**
+ * @brief Handles requests like protoHandler in main.c.
+ */
+static uint8_t handler(uint8_t op, uint8_t seq, const uint8_t* data, uint16_t len) {
+
+  PROTO_Stats_TypeDef stats;
+  uint8_t status = PROTO_OK;
+
+  switch (op) {
+
+  case PROTO_OP_PING:
+    PROTO_Reply(op, seq, data, len);
+    break;
+
+  case PROTO_OP_LED:
+    if (len != 2 || data[0] >= sizeof(leds) || data[1] > 1) {
+      return PROTO_ERR_ARGS;
+    }
+    leds[data[0]] = data[1];
+    PROTO_Reply(op, seq, &status, 1);
+    // LED 9 turned on makes the TX FIFO full (to test drops)
+    txFree = leds[9] ? 10 : 1024;
+    break;
+
+  case PROTO_OP_STATS:
+    PROTO_GetStats(&stats);
+    PROTO_Reply(op, seq, (uint8_t*)&stats, sizeof(stats));
+    break;
+
+  default:
+    return PROTO_ERR_OPCODE;
+  }
+
+  return PROTO_OK;
+}
+
+int main(void) {
+
+  struct termios tio;
+  struct pollfd fds[2];
+  char buf[16];
+  int slave;
+
+  pty = posix_openpt(O_RDWR | O_NOCTTY);
+  if (pty < 0 || grantpt(pty) || unlockpt(pty)) {
+    perror("pty");
+    return 1;
+  }
+
+  // raw slave side - no echo or new line translation of binary data
+  slave = open(ptsname(pty), O_RDWR | O_NOCTTY);
+  tcgetattr(slave, &tio);
+  cfmakeraw(&tio);
+  tcsetattr(slave, TCSANOW, &tio);
+
+  fcntl(pty, F_SETFL, O_NONBLOCK);
+
+  PROTO_Init(0, 921600, handler);
+
+  printf("%s\n", ptsname(pty));
+  fflush(stdout);
+
+  fds[0].fd = pty;
+  fds[0].events = POLLIN;
+  fds[1].fd = STDIN_FILENO;
+  fds[1].events = POLLIN;
+
+  while (poll(fds, 2, -1) >= 0) {
+
+    if (fds[1].revents && read(STDIN_FILENO, buf, sizeof(buf)) <= 0) {
+      break;
+    }
+    if (fds[0].revents & POLLIN) {
+      PROTO_Update();
+    }
+  }
+
+  close(slave);
+  return 0;
+}
@@ -0,0 +1,118 @@
+#!/usr/bin/env python3
+#
+# @file    test_proto.py
+# @brief   Binary protocol loopback test over a pseudo terminal
+# @date    17 paź 2026
+# @author  Michal Ksiezopolski
+#
+# Usage: test_proto.py [./test_proto]
+#
+# Starts the device (test_proto.c - PROTO built for the host) and
+# sends requests to it with tools/proto_host.py through a pty.
+#
+# Copyright (c) 2026 Michal Ksiezopolski.
+# All rights reserved. This program and the
+# accompanying materials are made available
+# under the terms of the GNU Public License
+# v3.0 which accompanies this distribution,
+# and is available at
+# http://www.gnu.org/licenses/gpl.html
+
+import os
+import struct
+import subprocess
+import sys
+import tty
+
+sys.path.insert(0, os.path.join(os.path.dirname(os.path.abspath(__file__)), '..', 'tools'))
+
+from proto_host import *  # noqa: E402,F403
+
+failures = 0
+
+
+def check(cond, what):
+    global failures
+    if not cond:
+        print('test_proto.py: check failed: %s' % what)
+        failures += 1
+
+
+def stats(link):
+    op, data = link.request(OP_STATS)
+    return dict(zip(STATS, struct.unpack('<%dI' % len(STATS), data)))
+
+
+def test_codec():
+    """Checks the host encoder against known values."""
+    check(crc32_mpeg2(b'123456789') == 0x0376E6E7, 'CRC-32/MPEG-2 check value')
+    check(crc32_stm32(b'12345678') == crc32_mpeg2(b'12345678'), 'CRC of whole words')
+    check(crc32_stm32(b'123') == crc32_mpeg2(b'123\0'), 'CRC padding')
+    check(cobs_encode(b'') == b'\x01', 'COBS empty')
+    check(cobs_encode(b'\0') == b'\x01\x01', 'COBS zero')
+    check(cobs_encode(b'\x11\x22\0\x33') == b'\x03\x11\x22\x02\x33', 'COBS example')
+    for data in (bytes(range(256)) * 2, b'\xff' * 254, b'\xff' * 255, b'\0' * 10):
+        enc = cobs_encode(data)
+        check(0 not in enc and cobs_decode(enc) == data, 'COBS round trip')
+    packet = encode_packet(OP_PING, 7, b'\0abc\0')
+    check(packet[-1:] == DELIMITER and decode_packet(packet[:-1]) == (OP_PING, 7, b'\0abc\0'),
+          'packet round trip')
+
+
+def test_device(link):
+    """Sends requests to the device."""
+    for payload in (b'', b'\0', b'hello', bytes(range(240)), b'\xff' * 240):
+        op, data = link.request(OP_PING, payload)
+        check(op == OP_PING | REPLY and data == payload, 'ping %d bytes' % len(payload))
+
+    check(link.request(OP_LED, b'\x03\x01') == (OP_LED | REPLY, b'\0'), 'LED on')
+    check(link.request(OP_LED, b'\x0a\x01') == (OP_LED | REPLY, b'\2'), 'invalid LED')
+    check(link.request(0x42) == (0x42 | REPLY, b'\1'), 'unknown opcode')
+
+    before = stats(link)
+
+    # bad CRC and bad encoding are counted and not answered
+    packet = bytearray(cobs_decode(encode_packet(OP_PING, 1, b'abcd')[:-1]))
+    packet[5] ^= 0x01
+    os.write(link.fd, cobs_encode(packet) + DELIMITER)
+    os.write(link.fd, b'\x05\x01\x02' + DELIMITER)
+    os.write(link.fd, DELIMITER)  # empty frames are ignored
+    check(link.receive(0.2) is None, 'no reply to bad packets')
+
+    after = stats(link)
+    check(after['crcErrors'] == before['crcErrors'] + 1, 'CRC error counted')
+    check(after['frameErrors'] == before['frameErrors'] + 1, 'frame error counted')
+    check(after['rxPackets'] == before['rxPackets'] + 1, 'stats request counted')
+
+    # replies that don't fit in the TX FIFO are dropped whole
+    link.send(OP_LED, b'\x09\x01')  # makes the device TX FIFO full
+    link.send(OP_PING, b'lost')
+    link.send(OP_LED, b'\x09\x00')
+    check(link.receive(0.2) == encode_packet(OP_LED | REPLY, link.seq - 2, b'\0')[:-1],
+          'reply before TX FIFO full')
+    check(link.receive(0.2) is None, 'no reply while TX FIFO full')
+    check(stats(link)['txDropped'] == 2, 'dropped replies counted')
+
+
+def main():
+    device = sys.argv[1] if len(sys.argv) > 1 else './test_proto'
+    test_codec()
+
+    proc = subprocess.Popen([device], stdin=subprocess.PIPE, stdout=subprocess.PIPE)
+    try:
+        fd = os.open(proc.stdout.readline().decode().strip(), os.O_RDWR | os.O_NOCTTY)
+        tty.setraw(fd)
+        test_device(Link(fd))
+        os.close(fd)
+    except ProtoError as e:
+        check(False, str(e))
+    finally:
+        proc.stdin.close()
+        proc.wait(5)
+
+    print('test_proto: %s' % ('%d checks FAILED' % failures if failures else 'OK'))
+    sys.exit(1 if failures else 0)
+
+
+if __name__ == '__main__':
+    main()
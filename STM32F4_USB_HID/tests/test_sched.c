@@ -0,0 +1,274 @@
+/**
+ * @file    test_sched.c
+ * @brief   Scheduler determinism tests and benchmark
+ * @date    17 paź 2026
+ * @author  Michal Ksiezopolski
+ *
+ * @details Records the order in which tasks run for given events and
+ * checks it against the priorities. The soft timers run on the fake
+ * SysTick, TIMER_GetCycles advances by stubCycles on every read.
+ *
+ * @verbatim
+ * Copyright (c) 2026 Michal Ksiezopolski.
+ * All rights reserved. This program and the
+ * accompanying materials are made available
+ * under the terms of the GNU Public License
+ * v3.0 which accompanies this distribution,
+ * and is available at
+ * http://www.gnu.org/licenses/gpl.html
+ * @endverbatim
+ */
+
+#include <test.h>
+#include <hal_stubs.h>
+#include <task_sched.h>
+#include <timers.h>
+#include <cmd.h>
+#include <comm.h>
+#include <format.h>
+#include <string.h>
+
+#define BENCH_RUNS 1000000 ///< Task runs in the benchmark
+
+static char commOut[1024];  ///< Terminal output
+static uint16_t commLen;    ///< Length of terminal output
+
+uint16_t COMM_Printf(const char* fmt, ...) {
+
+  va_list args;
+  uint16_t n;
+
+  va_start(args, fmt);
+  n = FORMAT_Vsnprintf(&commOut[commLen], sizeof(commOut) - commLen, fmt, args);
+  va_end(args);
+  commLen += n;
+
+  return n;
+}
+
+static char trace[256];     ///< Names of tasks in order of running
+static uint8_t traceLen;    ///< Length of trace
+static uint32_t lastEvents[256]; ///< Events of last run of every task
+static int8_t ids[256];     ///< Task IDs by name
+static char chain[256];     ///< Task posted by a task when it runs
+static char names[SCHED_MAX_TASKS][2]; ///< Task names
+
+/**
+ * @brief Test task - ctx is its one letter name.
+ */
+static void task(void* ctx, uint32_t events) {
+
+  uint8_t name = (uintptr_t)ctx;
+
+  trace[traceLen++] = name;
+  trace[traceLen] = 0;
+  lastEvents[name] = events;
+
+  if (chain[name]) {
+    SCHED_Post(ids[(uint8_t)chain[name]], 1);
+  }
+
+  SCHED_Poll(); // idle hook of a blocking call doesn't run other tasks
+}
+/**
+ * @brief Polls the scheduler.
+ * @param n Number of polls
+ */
+static void runPolls(int n) {
+  while (n--) {
+    SCHED_Poll();
+  }
+}
+/**
+ * @brief Clears the order of runs.
+ */
+static void clearTrace(void) {
+  traceLen = 0;
+  trace[0] = 0;
+}
+/**
+ * @brief Runs the ready tasks.
+ * @return Order of runs
+ */
+static const char* runAll(void) {
+
+  clearTrace();
+  runPolls(100);
+
+  return trace;
+}
+/**
+ * @brief Posts event 1 to the tasks named in a string.
+ */
+static void post(const char* names) {
+  while (*names) {
+    SCHED_Post(ids[(uint8_t)*names++], 1);
+  }
+}
+/**
+ * @brief Adds a test task.
+ */
+static void addTask(char name, uint8_t priority) {
+
+  static uint8_t count;
+
+  names[count][0] = name;
+  ids[(uint8_t)name] = SCHED_AddTask(names[count], priority, task,
+      (void*)(uintptr_t)name);
+  count++;
+}
+/**
+ * @brief Checks the order of task runs.
+ */
+static void testOrder(void) {
+
+  stubTime = 100;
+  TIMER_Init(1000);
+  SCHED_Init();
+
+  // added out of priority order like in main.c
+  addTask('b', 4);
+  addTask('c', 3);
+  addTask('h', 0);
+  addTask('p', 2);
+  addTask('k', 1);
+  addTask('x', 2);  // same priority as 'p', added later
+  TEST_CHECK(ids['b'] == 0 && ids['x'] == 5);
+
+  // highest priority first, equal priorities in order of adding
+  post("bcxphk");
+  TEST_CHECK(strcmp(runAll(), "hkpxcb") == 0);
+  post("xp");
+  TEST_CHECK(strcmp(runAll(), "px") == 0);
+
+  // a task posted by a running task goes ahead of lower priorities
+  chain['c'] = 'h';
+  post("cb");
+  TEST_CHECK(strcmp(runAll(), "chb") == 0);
+  chain['c'] = 0;
+
+  // a task posted to itself runs again after higher priorities
+  chain['p'] = 'p';
+  post("p");
+  clearTrace();
+  runPolls(3);
+  post("hb");
+  runPolls(2);
+  chain['p'] = 0;
+  runPolls(100);
+  TEST_CHECK(strcmp(trace, "ppphppb") == 0);
+
+  // events are bits collected until the task runs
+  SCHED_Post(ids['k'], 0x1);
+  SCHED_Post(ids['k'], 0x4);
+  SCHED_Post(ids['k'], 0x4);
+  TEST_CHECK(strcmp(runAll(), "k") == 0);
+  TEST_CHECK(lastEvents['k'] == 0x5);
+
+  // invalid IDs are ignored
+  SCHED_Post(SCHED_MAX_TASKS, 1);
+  TEST_CHECK(strcmp(runAll(), "") == 0);
+}
+/**
+ * @brief Checks that the same events give the same order every time.
+ */
+static void testDeterminism(void) {
+
+  static char first[256];
+  int16_t timer;
+
+  // soft timers post events between tasks
+  timer = TIMER_AddSoftTimer(5, TIMER_PERIODIC, SCHED_Notify,
+      SCHED_NOTIFY_CTX(ids['h']));
+  TIMER_StartSoftTimer(timer);
+  chain['b'] = 'c';
+  chain['c'] = 'x';
+
+  for (int round = 0; round < 2; round++) {
+
+    clearTrace();
+
+    for (int t = 0; t < 20; t++) {
+      post(t % 3 ? "b" : "kb");
+      runPolls(2);
+      stubTime++;
+    }
+    runPolls(10);
+
+    if (round == 0) {
+      strcpy(first, trace);
+    }
+  }
+
+  TEST_CHECK(strcmp(first, trace) == 0);
+  TEST_CHECK(lastEvents['h'] == SCHED_EVENT_NOTIFY);
+  TEST_CHECK(strcmp(first,
+      "kbcxbckxbchxkbcxbckxhbcxkbcxbchkxbcxkbcxhbcx") == 0);
+
+  TIMER_DeleteSoftTimer(timer);
+  chain['b'] = 0;
+  chain['c'] = 0;
+}
+/**
+ * @brief Checks the task statistics and the :TASKS command.
+ */
+static void testStats(void) {
+
+  SCHED_Stats_TypeDef before, after;
+  char expected[64];
+
+  SCHED_GetStats(ids['k'], &before);
+  stubCycles = 840; // every run takes 10 us
+  post("k");
+  runAll();
+  stubCycles = 0;
+  SCHED_GetStats(ids['k'], &after);
+
+  TEST_CHECK(after.runs == before.runs + 1);
+  TEST_CHECK(after.totalCycles == before.totalCycles + 840);
+  TEST_CHECK(after.maxCycles == 840);
+
+  // fill the table
+  while (SCHED_AddTask("z", 7, task, (void*)'z') >= 0);
+  TEST_CHECK(SCHED_AddTask("z", 7, task, (void*)'z') == -1);
+
+  stubTime += 1000;
+  commLen = 0;
+  TEST_CHECK(CMD_Dispatch(":TASKS", 6) == 0);
+  TEST_CHECK(strncmp(commOut, "SCHED--> h        prio 0 runs", 29) == 0);
+  snprintf(expected, sizeof(expected), "SCHED--> k        prio 1 runs %u max 10 us",
+      (unsigned)after.runs);
+  TEST_CHECK(strstr(commOut, expected) != NULL);
+}
+/**
+ * @brief Measures the cost of picking and running a task.
+ */
+static void benchmark(void) {
+
+  double start;
+
+  chain['b'] = 'b'; // lowest priority task keeps itself ready
+  post("b");
+
+  start = TEST_Seconds();
+  for (uint32_t i = 0; i < BENCH_RUNS; i++) {
+    SCHED_Poll();
+  }
+  start = TEST_Seconds() - start;
+
+  chain['b'] = 0;
+  runAll();
+
+  printf("bench %u tasks: %.0f ns per task run\n", (unsigned)SCHED_MAX_TASKS,
+      start / BENCH_RUNS * 1e9);
+}
+
+int main(void) {
+
+  testOrder();
+  testDeterminism();
+  testStats();
+  benchmark();
+
+  return TEST_Result("test_sched");
+}
@@ -0,0 +1,262 @@
+/**
+ * @file    test_systick.c
+ * @brief   Tests of the tickless SysTick sleep
+ * @date    17 paź 2026
+ * @author  Michal Ksiezopolski
+ *
+ * @details Runs hal/src/systick.c on a simulated SysTick counter
+ * clocked at 168 MHz and TIMER5 at 84 MHz. Every register access
+ * takes a few cycles and waking up takes more, like on the MCU.
+ * The test mixes busy time, sleeps of random length, early wake ups
+ * and late tick interrupts, and checks after each sleep that:
+ * - the system time equals the time passed (in whole ticks), also
+ *   after tick interrupts held back for more than a tick,
+ * - a sleep that isn't woken early lasts exactly the given ticks,
+ * - the SysTick interrupt comes right after the tick boundary, so
+ *   the ticks don't drift.
+ *
+ * @verbatim
+ * Copyright (c) 2026 Michal Ksiezopolski.
+ * All rights reserved. This program and the
+ * accompanying materials are made available
+ * under the terms of the GNU Public License
+ * v3.0 which accompanies this distribution,
+ * and is available at
+ * http://www.gnu.org/licenses/gpl.html
+ * @endverbatim
+ */
+
+#include <test.h>
+#include <systick.h>
+#include <timer5.h>
+#include <stm32f4xx.h>
+#include <stdlib.h>
+
+#define TICK_CYCLES   168000  ///< SysTick cycles per ms
+#define ACCESS_CYCLES 6       ///< Cycles of a register access
+#define WAKE_CYCLES   40      ///< Cycles from a wake up event to running code
+#define MAX_LAG       400     ///< Allowed delay of a tick interrupt (cycles)
+#define ENTRY_MARGIN  1000    ///< Cycles to the next tick for an exact sleep
+#define ROUNDS        200000  ///< Sleeps of the random test
+
+void SysTick_Handler(void);
+
+static uint64_t now;              ///< Time in SysTick cycles
+static SysTick_Type sysTick;      ///< SysTick registers seen by the code
+static SCB_Type scb;              ///< SCB registers seen by the code
+static uint32_t counter;          ///< SysTick counter
+static uint32_t shownVal;         ///< Counter value last shown in VAL
+static uint8_t pending;           ///< SysTick interrupt pending
+static uint64_t pendTime;         ///< Time the interrupt became pending
+static uint64_t wakeTime = UINT64_MAX; ///< Time of another interrupt
+static uint64_t gridStart;        ///< Time of the first tick stamp
+static uint32_t maxLag;           ///< Longest delay of a tick interrupt
+
+/**
+ * @brief Runs the counter for a number of cycles.
+ * @details The counter counts down to 0, raises the interrupt and
+ * loads LOAD on the next cycle.
+ */
+static void run(uint64_t cycles) {
+
+  uint64_t step;
+
+  if (!(sysTick.CTRL & SysTick_CTRL_ENABLE_Msk)) {
+    now += cycles;
+    return;
+  }
+
+  while (cycles) {
+    if (counter == 0) {
+      counter = sysTick.LOAD;
+      now++;
+      cycles--;
+      continue;
+    }
+    step = cycles < counter ? cycles : counter;
+    counter -= step;
+    now += step;
+    cycles -= step;
+    if (counter == 0 && !pending) {
+      pending = 1;
+      pendTime = now;
+    }
+  }
+}
+/**
+ * @brief Applies register writes, lets an access pass and shows the
+ * current values.
+ */
+static void sync(void) {
+
+  if (sysTick.VAL != shownVal) { // any write clears the counter
+    counter = 0;
+  }
+  if (scb.ICSR & SCB_ICSR_PENDSTCLR_Msk) {
+    pending = 0;
+  }
+
+  run(ACCESS_CYCLES);
+
+  sysTick.VAL = shownVal = counter;
+  scb.ICSR = pending ? SCB_ICSR_PENDSTSET_Msk : 0;
+}
+
+SysTick_Type* stubSysTick(void) {
+  sync();
+  return &sysTick;
+}
+
+SCB_Type* stubScb(void) {
+  sync();
+  return &scb;
+}
+
+void stubWfe(void) {
+
+  uint64_t cycles;
+
+  sync();
+
+  if (!pending && now < wakeTime) {
+    // until the counter reaches 0 or the other interrupt comes
+    cycles = wakeTime - now;
+    if ((sysTick.CTRL & SysTick_CTRL_ENABLE_Msk) && sysTick.LOAD) {
+      uint64_t alarm = counter ? counter : 1 + (uint64_t)sysTick.LOAD;
+      if (alarm < cycles) {
+        cycles = alarm;
+      }
+    }
+    run(cycles);
+  }
+
+  if (now >= wakeTime) {
+    wakeTime = UINT64_MAX;
+  }
+
+  run(WAKE_CYCLES);
+}
+
+uint32_t TIMER5_GetTime(void) {
+  sync();
+  return (uint32_t)(now / 2);
+}
+
+uint32_t TIMER5_GetFreq(void) {
+  return 84000000;
+}
+
+/**
+ * @brief Runs the SysTick interrupt if it is pending.
+ */
+static void deliver(void) {
+
+  uint32_t lag;
+
+  sync();
+
+  if (pending) {
+    // the interrupt has to come right after a tick boundary
+    lag = (pendTime - gridStart) % TICK_CYCLES;
+    if (lag > maxLag) {
+      maxLag = lag;
+    }
+    pending = 0;
+    SysTick_Handler();
+  }
+}
+/**
+ * @brief Busy main loop time - interrupts are taken at once.
+ */
+static void busy(uint64_t cycles) {
+
+  uint64_t step;
+
+  while (cycles) {
+    step = cycles < TICK_CYCLES / 4 ? cycles : TICK_CYCLES / 4;
+    sync();
+    run(step);
+    cycles -= step;
+    deliver();
+  }
+}
+/**
+ * @brief Returns the whole ticks passed since the first tick stamp.
+ */
+static uint64_t ticksPassed(void) {
+  return (now - gridStart) / TICK_CYCLES;
+}
+
+int main(void) {
+
+  uint64_t before;
+  uint64_t passed;
+  uint32_t ticks;
+  uint8_t woken;
+  uint8_t exact;
+  uint32_t early = 0, late = 0, due = 0;
+
+  srand(1);
+
+  now = 1000;
+  gridStart = (now + ACCESS_CYCLES) & ~1ULL; // first TIMER5 read
+  SYSTICK_Init(1000);
+  busy(3 * TICK_CYCLES);
+  TEST_CHECK(SYSTICK_GetTime64() == 3);
+
+  for (uint32_t round = 0; round < ROUNDS; round++) {
+
+    busy(rand() % (2 * TICK_CYCLES));
+
+    switch (rand() % 8) {
+    case 0: // tick interrupt held back for a few ticks
+      sync();
+      run(rand() % (3 * TICK_CYCLES));
+      deliver();
+      late++;
+      break;
+    case 1: // tick due, but its interrupt didn't run yet
+      sync();
+      run(TICK_CYCLES);
+      due++;
+      break;
+    }
+
+    ticks = 1 + rand() % 60;
+    woken = rand() % 2;
+    if (woken) { // another interrupt wakes the core early
+      wakeTime = now + rand() % ((uint64_t)ticks * TICK_CYCLES);
+      early++;
+    }
+
+    before = SYSTICK_GetTime64();
+    passed = ticksPassed();
+    // a tick coming due on the way in ends the sleep at once
+    exact = !woken && passed == before && !pending && ticks > 1 &&
+        (now - gridStart) % TICK_CYCLES < TICK_CYCLES - ENTRY_MARGIN;
+    SYSTICK_Sleep(ticks);
+
+    if (exact) {
+      TEST_CHECK(SYSTICK_GetTime64() == before + ticks);
+    }
+    wakeTime = UINT64_MAX;
+
+    deliver();
+
+    // the interrupt of the current tick may be a few cycles away
+    passed = ticksPassed();
+    TEST_CHECK(SYSTICK_GetTime64() == passed ||
+        SYSTICK_GetTime64() + 1 == passed);
+    if (testFailures > 10) {
+      break;
+    }
+  }
+
+  TEST_CHECK(maxLag <= MAX_LAG);
+
+  printf("%u sleeps (%u woken early, %u late ticks, %u due), %.0f s, "
+      "ticks at most %u cycles late\n", (unsigned)ROUNDS, (unsigned)early,
+      (unsigned)late, (unsigned)due, now / 168e6, (unsigned)maxLag);
+
+  return TEST_Result("test_systick");
+}
@@ -0,0 +1,423 @@
+/**
+ * @file    test_timers.c
+ * @brief   Soft timer tests and benchmark
+ * @date    17 paź 2026
+ * @author  Michal Ksiezopolski
+ *
+ * @details The system time is the fake SysTick of the stubs, so the
+ * tests control when every tick happens. Build with a large
+ * MAX_SOFT_TIMERS for the benchmark.
+ *
+ * @verbatim
+ * Copyright (c) 2026 Michal Ksiezopolski.
+ * All rights reserved. This program and the
+ * accompanying materials are made available
+ * under the terms of the GNU Public License
+ * v3.0 which accompanies this distribution,
+ * and is available at
+ * http://www.gnu.org/licenses/gpl.html
+ * @endverbatim
+ */
+
+#include <test.h>
+#include <hal_stubs.h>
+#include <timers.h>
+#include <stdlib.h>
+
+#define TEST_TIMERS  200   ///< Timers in the wheel test
+#define DRIFT_PERIODS 1000000 ///< Periods of the drift test
+#define BENCH_TICKS  100000 ///< Ticks of every benchmark run
+
+/**
+ * @brief State of a test timer.
+ */
+typedef struct {
+  int16_t  id;      ///< Timer ID
+  uint32_t period;  ///< Period in ms
+  uint64_t next;    ///< Expected time of next overflow
+  uint32_t count;   ///< Number of overflows
+  uint32_t late;    ///< Number of overflows at a wrong time
+  uint32_t maxLate; ///< Longest delay of an overflow
+} TEST_Timer_TypeDef;
+
+static TEST_Timer_TypeDef timers[1000];
+
+/**
+ * @brief Overflow function - checks the time of the overflow.
+ */
+static void overflow(void* ctx) {
+
+  TEST_Timer_TypeDef* timer = ctx;
+
+  if (stubTime != timer->next) {
+    timer->late++;
+  }
+  if (stubTime - timer->next > timer->maxLate) {
+    timer->maxLate = stubTime - timer->next;
+  }
+  timer->next += timer->period;
+  timer->count++;
+}
+/**
+ * @brief Adds and starts count periodic test timers.
+ * @param count Number of timers
+ * @param maxPeriod Longest period
+ */
+static void startTimers(uint16_t count, uint32_t maxPeriod) {
+
+  TIMER_Init(1000);
+
+  for (uint16_t i = 0; i < count; i++) {
+    timers[i].period = 1 + rand() % maxPeriod;
+    timers[i].next = stubTime + timers[i].period;
+    timers[i].count = 0;
+    timers[i].late = 0;
+    timers[i].id = TIMER_AddSoftTimer(timers[i].period, TIMER_PERIODIC,
+        overflow, &timers[i]);
+    TIMER_StartSoftTimer(timers[i].id);
+  }
+}
+/**
+ * @brief Checks that timers in all wheel slots and rounds overflow
+ * exactly on time.
+ */
+static void testWheel(void) {
+
+  uint64_t start;
+  uint32_t late = 0;
+  uint32_t wrong = 0;
+
+  stubTime = 12345;
+  start = stubTime;
+  srand(1);
+  startTimers(TEST_TIMERS, 300); // many periods longer than the wheel
+
+  for (uint32_t t = 0; t < 30000; t++) {
+    stubTime++;
+    TIMER_SoftTimersUpdate();
+  }
+
+  for (uint16_t i = 0; i < TEST_TIMERS; i++) {
+    late += timers[i].late;
+    wrong += timers[i].count != (stubTime - start) / timers[i].period;
+  }
+  TEST_CHECK(late == 0);
+  TEST_CHECK(wrong == 0);
+
+  // stopped timers don't overflow
+  for (uint16_t i = 0; i < TEST_TIMERS; i++) {
+    TIMER_StopSoftTimer(timers[i].id);
+    timers[i].count = 0;
+  }
+  for (uint32_t t = 0; t < 1000; t++) {
+    stubTime++;
+    TIMER_SoftTimersUpdate();
+  }
+  for (uint16_t i = 0; i < TEST_TIMERS; i++) {
+    TEST_CHECK(timers[i].count == 0);
+  }
+}
+/**
+ * @brief Advances the time and updates the timers every tick.
+ * @param ms Number of ticks
+ */
+static void runTicks(uint32_t ms) {
+
+  while (ms--) {
+    stubTime++;
+    TIMER_SoftTimersUpdate();
+  }
+}
+/**
+ * @brief Checks that a periodic timer updated at random moments
+ * doesn't drift over DRIFT_PERIODS periods.
+ */
+static void testDrift(void) {
+
+  TEST_Timer_TypeDef* timer = &timers[0];
+  uint64_t start;
+
+  stubTime = 1000;
+  start = stubTime;
+  srand(3);
+
+  TIMER_Init(1000);
+  timer->period = 20; // HID report period
+  timer->next = start + timer->period;
+  timer->count = 0;
+  timer->maxLate = 0;
+  timer->id = TIMER_AddSoftTimer(timer->period, TIMER_PERIODIC, overflow, timer);
+  TIMER_StartSoftTimer(timer->id);
+
+  // a busy main loop updates the timers 1 to 7 ms late
+  while (timer->count < DRIFT_PERIODS) {
+    stubTime += 1 + rand() % 7;
+    TIMER_SoftTimersUpdate();
+  }
+
+  // lateness doesn't accumulate - the last overflow is on phase
+  TEST_CHECK(timer->next == start + (uint64_t)(DRIFT_PERIODS + 1) * timer->period);
+  TEST_CHECK(timer->maxLate < 7);
+
+  printf("drift: %u periods of %u ms, max late %u ms, drift %d ms\n",
+      (unsigned)DRIFT_PERIODS, (unsigned)timer->period, (unsigned)timer->maxLate,
+      (int)(timer->next - start - (uint64_t)(DRIFT_PERIODS + 1) * timer->period));
+
+  // after a break longer than the wheel the missed periods are
+  // skipped, keeping the phase
+  timer->count = 0;
+  stubTime += 10 * timer->period + 3;
+  TIMER_SoftTimersUpdate();
+  TEST_CHECK(timer->count >= 1 && timer->count < 10);
+  timer->count = 0;
+  timer->next = stubTime - stubTime % timer->period + timer->period;
+  timer->late = 0;
+  runTicks(10 * timer->period);
+  TEST_CHECK(timer->count == 10 && timer->late == 0);
+}
+
+static uint32_t oneShotCount; ///< Overflows of the one shot timer
+
+/**
+ * @brief Overflow function of the one shot timer.
+ */
+static void oneShot(void* ctx) {
+  oneShotCount++;
+  TEST_CHECK(ctx == &oneShotCount);
+}
+/**
+ * @brief Overflow function deleting its own timer.
+ */
+static void deleteSelf(void* ctx) {
+  TIMER_DeleteSoftTimer(*(int16_t*)ctx);
+  oneShotCount++;
+}
+/**
+ * @brief Checks one shot timers, deleting and pausing.
+ */
+static void testModes(void) {
+
+  static int16_t ids[1000];
+  int16_t id;
+  int16_t self;
+  uint16_t count = 0;
+
+  stubTime = 500;
+  TIMER_Init(1000);
+
+  // one shot timer overflows once and can be started again
+  id = TIMER_AddSoftTimer(10, TIMER_ONE_SHOT, oneShot, &oneShotCount);
+  TIMER_StartSoftTimer(id);
+  runTicks(9);
+  TEST_CHECK(oneShotCount == 0);
+  runTicks(1);
+  TEST_CHECK(oneShotCount == 1);
+  runTicks(100);
+  TEST_CHECK(oneShotCount == 1);
+  TIMER_StartSoftTimer(id);
+  runTicks(10);
+  TEST_CHECK(oneShotCount == 2);
+
+  // deleted IDs are reused, the table never overflows
+  TIMER_DeleteSoftTimer(id);
+  TEST_CHECK(TIMER_AddSoftTimer(10, TIMER_ONE_SHOT, oneShot, &oneShotCount) == id);
+  while ((id = TIMER_AddSoftTimer(1, TIMER_PERIODIC, NULL, NULL)) >= 0) {
+    ids[count++] = id;
+  }
+  TEST_CHECK(count == 999);
+  // the error of a failed add used as an ID is ignored
+  TIMER_StartSoftTimer(id);
+  TIMER_PauseSoftTimer(id);
+  TIMER_ResumeSoftTimer(id);
+  TIMER_StopSoftTimer(id);
+  TIMER_DeleteSoftTimer(id);
+  TIMER_DeleteSoftTimer(ids[500]);
+  TEST_CHECK(TIMER_AddSoftTimer(1, TIMER_PERIODIC, NULL, NULL) == ids[500]);
+
+  // a timer can delete itself from its overflow function
+  TIMER_Init(1000);
+  oneShotCount = 0;
+  self = TIMER_AddSoftTimer(5, TIMER_PERIODIC, deleteSelf, &self);
+  TIMER_StartSoftTimer(self);
+  runTicks(50);
+  TEST_CHECK(oneShotCount == 1);
+  TEST_CHECK(TIMER_AddSoftTimer(5, TIMER_PERIODIC, NULL, NULL) == self);
+
+  // paused timer keeps its remaining time
+  TIMER_Init(1000);
+  oneShotCount = 0;
+  id = TIMER_AddSoftTimer(100, TIMER_ONE_SHOT, oneShot, &oneShotCount);
+  TIMER_StartSoftTimer(id);
+  runTicks(30);
+  TIMER_PauseSoftTimer(id);
+  runTicks(500);
+  TIMER_ResumeSoftTimer(id);
+  runTicks(69);
+  TEST_CHECK(oneShotCount == 0);
+  runTicks(1);
+  TEST_CHECK(oneShotCount == 1);
+
+  // timer paused when already due overflows right after resume
+  TIMER_StartSoftTimer(id);
+  stubTime += 150; // not updated yet
+  TIMER_PauseSoftTimer(id);
+  runTicks(1000);
+  TEST_CHECK(oneShotCount == 1);
+  TIMER_ResumeSoftTimer(id);
+  runTicks(1);
+  TEST_CHECK(oneShotCount == 2);
+}
+/**
+ * @brief Runs an idle main loop with tickless sleep.
+ * @param ms Time to run
+ * @param count Number of test timers
+ * @return Number of overflows
+ */
+static uint32_t runIdle(uint32_t ms, uint16_t count) {
+
+  uint64_t end = stubTime + ms;
+  uint32_t calls = 0;
+
+  while (stubTime < end) {
+    TIMER_SoftTimersUpdate();
+    TIMER_Idle(); // fake SYSTICK_Sleep moves the time to the wake up
+  }
+  TIMER_SoftTimersUpdate(); // overflows at the end
+
+  for (uint16_t i = 0; i < count; i++) {
+    calls += timers[i].count;
+    TEST_CHECK(timers[i].late == 0);
+  }
+
+  return calls;
+}
+/**
+ * @brief Checks that the core sleeps until the nearest overflow.
+ */
+static void testTickless(void) {
+
+  const uint32_t periods[] = { 20, 1000, 333, 7 };
+  uint32_t calls;
+  uint32_t wakeups = 0;
+
+  stubTime = 0xFFFF0000; // 32 bit time overflows during the test
+  TIMER_Init(1000);
+
+  for (uint16_t i = 0; i < 4; i++) {
+    timers[i].period = periods[i];
+    timers[i].next = stubTime + periods[i];
+    timers[i].count = 0;
+    timers[i].late = 0;
+    timers[i].id = TIMER_AddSoftTimer(periods[i], TIMER_PERIODIC, overflow, &timers[i]);
+    TIMER_StartSoftTimer(timers[i].id);
+  }
+
+  // wake up only for overflows, all of them on time
+  stubSleeps = 0;
+  calls = runIdle(1000000, 4);
+  for (uint32_t t = 1; t <= 1000000; t++) {
+    wakeups += t % 20 == 0 || t % 1000 == 0 || t % 333 == 0 || t % 7 == 0;
+  }
+  TEST_CHECK(calls == 1000000 / 20 + 1000000 / 1000 + 1000000 / 333 + 1000000 / 7);
+  TEST_CHECK(stubSleeps == wakeups);
+  printf("tickless: %u overflows in 10^6 ms, %u sleeps\n", (unsigned)calls,
+      (unsigned)stubSleeps);
+
+  // other interrupts end the sleep early - timers are still on time
+  stubSleepMax = 3;
+  for (uint16_t i = 0; i < 4; i++) {
+    timers[i].count = 0;
+  }
+  TEST_CHECK(runIdle(100000, 4) >= 100000 / 7);
+  for (uint16_t i = 0; i < 4; i++) {
+    // no overflow missed
+    TEST_CHECK(timers[i].next > stubTime && timers[i].next <= stubTime + periods[i]);
+  }
+  stubSleepMax = 0;
+
+  // nearest overflow beyond one round of the wheel
+  TIMER_Init(1000);
+  timers[0].period = 5000;
+  timers[0].next = stubTime + 5000;
+  timers[0].count = 0;
+  timers[0].id = TIMER_AddSoftTimer(5000, TIMER_PERIODIC, overflow, &timers[0]);
+  TIMER_StartSoftTimer(timers[0].id);
+  stubSleeps = 0;
+  TEST_CHECK(runIdle(100000, 1) == 20);
+  TEST_CHECK(stubSleeps == 20);
+
+  // no sleep while ticks are waiting for TIMER_SoftTimersUpdate
+  stubSleeps = 0;
+  stubTime++;
+  TIMER_Idle();
+  TEST_CHECK(stubSleeps == 0);
+}
+/**
+ * @brief Checks the 64 bit time and deadlines across the 32 bit
+ * overflow.
+ */
+static void testDeadlines(void) {
+
+  uint64_t deadline;
+
+  stubTime = 0xFFFFFFF0;
+  deadline = TIMER_DeadlineAfter(100);
+  TEST_CHECK(TIMER_Now64() == 0xFFFFFFF0);
+  TEST_CHECK(TIMER_GetTime() == 0xFFFFFFF0);
+
+  stubTime += 100; // the current tick has partly passed at the start
+  TEST_CHECK(!TIMER_DeadlineExpired(deadline));
+  stubTime++;
+  TEST_CHECK(TIMER_DeadlineExpired(deadline));
+  TEST_CHECK(TIMER_GetTime() == 0x55); // 32 bit time overflowed
+
+  // deadlines further than 2^31 ms work too
+  deadline = TIMER_DeadlineAfter(0xFFFFFFFF);
+  stubTime += 0x80000001;
+  TEST_CHECK(!TIMER_DeadlineExpired(deadline));
+  stubTime += 0x7FFFFFFF;
+  TEST_CHECK(TIMER_DeadlineExpired(deadline));
+
+  TEST_CHECK(TIMER_DeadlineExpired(0)); // zero - always expired
+}
+/**
+ * @brief Measures the cost of a tick with count timers.
+ * @param count Number of timers
+ */
+static void benchmark(uint16_t count) {
+
+  uint32_t calls = 0;
+  double start;
+
+  srand(2);
+  startTimers(count, 1000);
+
+  start = TEST_Seconds();
+  for (uint32_t t = 0; t < BENCH_TICKS; t++) {
+    stubTime++;
+    TIMER_SoftTimersUpdate();
+  }
+  start = TEST_Seconds() - start;
+
+  for (uint16_t i = 0; i < count; i++) {
+    calls += timers[i].count;
+  }
+
+  printf("bench %4u timers: %.0f ns per tick (%u overflows)\n",
+      (unsigned)count, start / BENCH_TICKS * 1e9, (unsigned)calls);
+}
+
+int main(void) {
+
+  testWheel();
+  testDrift();
+  testModes();
+  testTickless();
+  testDeadlines();
+
+  benchmark(10);
+  benchmark(100);
+  benchmark(1000);
+
+  return TEST_Result("test_timers");
+}
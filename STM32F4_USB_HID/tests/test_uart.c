@@ -0,0 +1,203 @@
+/**
+ * @file    test_uart.c
+ * @brief   Tests of DMA transmission chaining over the TX FIFO
+ * @date    17 paź 2026
+ * @author  Michal Ksiezopolski
+ *
+ * @details Runs COMM with hal/src/uart.c on the fake peripherals of
+ * stubs/stm32f4xx.h. Data is written in blocks of random length, so
+ * the TX FIFO wraps many times, and the transfers are completed by
+ * calling the DMA interrupt handler. Each transfer is checked to start
+ * at the FIFO tail and to stay within the contiguous run before the
+ * end of the buffer. The bytes sent by all transfers have to match
+ * the bytes written.
+ *
+ * @verbatim
+ * Copyright (c) 2026 Michal Ksiezopolski.
+ * All rights reserved. This program and the
+ * accompanying materials are made available
+ * under the terms of the GNU Public License
+ * v3.0 which accompanies this distribution,
+ * and is available at
+ * http://www.gnu.org/licenses/gpl.html
+ * @endverbatim
+ */
+
+#include <test.h>
+#include <comm.h>
+#include <uart.h>
+#include <stdlib.h>
+
+#define BUF_LEN       64     ///< Length of the port buffers
+#define STREAM_BYTES  100000 ///< Bytes sent by the random test
+
+void DMA2_Stream7_IRQHandler(void);
+
+static uint8_t rxBuf[BUF_LEN];  ///< RX buffer of the port
+static uint8_t txBuf[BUF_LEN];  ///< TX buffer of the port
+static COMM_TypeDef port;       ///< Port on USART1 (TX DMA2 Stream7)
+
+static uint32_t written;  ///< Bytes queued with COMM_PortWrite
+static uint32_t sent;     ///< Bytes taken by finished transfers
+static uint32_t spans;    ///< Number of transfers
+static uint32_t wraps;    ///< Transfers that ended at the end of the buffer
+
+/**
+ * @brief Byte number i of the test stream.
+ */
+static inline uint8_t streamByte(uint32_t i) {
+  return (uint8_t)(i * 7 + (i >> 8));
+}
+
+/**
+ * @brief Queues the next len bytes of the test stream.
+ * @return Number of bytes queued
+ */
+static uint16_t writeStream(uint16_t len) {
+
+  uint8_t data[BUF_LEN];
+  uint16_t n;
+
+  for (uint16_t i = 0; i < len; i++) {
+    data[i] = streamByte(written + i);
+  }
+
+  n = COMM_PortWrite(&port, data, len);
+  written += n;
+
+  return n;
+}
+
+/**
+ * @brief Finishes the running transfer like the DMA would.
+ * @details Checks the transfer, compares its bytes with the test
+ * stream and calls the transfer complete interrupt, which chains the
+ * next transfer.
+ * @retval 0 DMA was idle
+ * @retval 1 Transfer finished
+ */
+static uint8_t finishTransfer(void) {
+
+  DMA_Stream_TypeDef* stream = DMA2_Stream7;
+  uint16_t tail = port.txFifo.tail & port.txFifo.mask;
+  uint16_t count = port.txFifo.head - port.txFifo.tail;
+  uint16_t run = count < BUF_LEN - tail ? count : BUF_LEN - tail;
+  // M0AR holds the low 32 bits of the host address
+  uint32_t offset = stream->M0AR - (uint32_t)(uintptr_t)txBuf;
+  uint16_t len = stream->NDTR;
+
+  if (!(stream->CR & DMA_SxCR_EN)) {
+    return 0;
+  }
+
+  TEST_CHECK(offset == tail);             // starts at the oldest byte
+  TEST_CHECK(len > 0 && len <= run);      // contiguous run only
+  if (offset != tail || len == 0 || len > run) {
+    exit(TEST_Result("test_uart"));
+  }
+
+  for (uint16_t i = 0; i < len; i++) {
+    if (txBuf[offset + i] != streamByte(sent + i)) {
+      TEST_CHECK(txBuf[offset + i] == streamByte(sent + i));
+      exit(TEST_Result("test_uart"));
+    }
+  }
+
+  sent += len;
+  spans++;
+  if (offset + len == BUF_LEN) {
+    wraps++;
+  }
+
+  stream->CR &= ~DMA_SxCR_EN;
+  stream->NDTR = 0;
+  stream->ISR |= DMA_FLAG_TCIF;
+  DMA2_Stream7_IRQHandler();
+
+  TEST_CHECK(!(stream->ISR & DMA_FLAG_TCIF)); // interrupt cleared
+
+  return 1;
+}
+
+/**
+ * @brief Checks a write wrapping around the end of the buffer.
+ * @details The first transfer has to stop at the end of the buffer
+ * and the wrapped part has to be chained from the interrupt, together
+ * with the data written while the first transfer was running.
+ */
+static void testWrap(void) {
+
+  UART_Stats_TypeDef stats;
+
+  TEST_CHECK(writeStream(40) == 40);
+  TEST_CHECK(DMA2_Stream7->NDTR == 40);
+  TEST_CHECK(finishTransfer() == 1);
+  TEST_CHECK(!(DMA2_Stream7->CR & DMA_SxCR_EN)); // FIFO empty - DMA idle
+
+  TEST_CHECK(writeStream(50) == 50);              // head wraps
+  TEST_CHECK(DMA2_Stream7->NDTR == BUF_LEN - 40); // up to the end only
+  TEST_CHECK(writeStream(10) == 10);              // while DMA runs
+  TEST_CHECK(DMA2_Stream7->NDTR == BUF_LEN - 40); // transfer not restarted
+  TEST_CHECK(finishTransfer() == 1);
+  TEST_CHECK(DMA2_Stream7->NDTR == 50 - (BUF_LEN - 40) + 10); // wrapped part
+  TEST_CHECK(finishTransfer() == 1);
+  TEST_CHECK(finishTransfer() == 0);
+
+  TEST_CHECK(sent == written);
+  TEST_CHECK(FIFO_IsEmpty(&port.txFifo));
+
+  UART_GetStats(UART_PORT1, &stats);
+  TEST_CHECK(stats.txBytes == sent);
+}
+
+/**
+ * @brief Writes and finishes transfers in random order.
+ */
+static void testRandom(void) {
+
+  UART_Stats_TypeDef stats;
+  uint16_t free;
+
+  srand(1);
+
+  while (written < STREAM_BYTES) {
+
+    free = COMM_PortTxFree(&port);
+
+    if (free && rand() % 3) {
+      writeStream(1 + rand() % free); // never drop - drops break the stream
+    } else if (!finishTransfer() && free == 0) {
+      TEST_CHECK(!"DMA idle with a full TX FIFO");
+      break;
+    }
+  }
+
+  while (finishTransfer());
+
+  TEST_CHECK(sent == written);
+  TEST_CHECK(FIFO_IsEmpty(&port.txFifo));
+  TEST_CHECK(port.txDropped == 0);
+  TEST_CHECK(wraps > 100);
+
+  UART_GetStats(UART_PORT1, &stats);
+  TEST_CHECK(stats.txBytes == sent);
+
+  printf("chained %u transfers, %u ended at the wrap point\n",
+      (unsigned)spans, (unsigned)wraps);
+}
+
+int main(void) {
+
+  port.port       = UART_PORT1;
+  port.baud       = 115200;
+  port.rxBuf      = rxBuf;
+  port.txBuf      = txBuf;
+  port.bufLen     = BUF_LEN;
+  port.terminator = '\r';
+  COMM_Add(&port);
+
+  testWrap();
+  testRandom();
+
+  return TEST_Result("test_uart");
+}
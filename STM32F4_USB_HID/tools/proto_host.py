@@ -0,0 +1,181 @@
+#!/usr/bin/env python3
+#
+# @file    proto_host.py
+# @brief   Host side of the binary protocol (see app/inc/proto.h)
+# @date    17 paź 2026
+# @author  Michal Ksiezopolski
+#
+# Usage: proto_host.py /dev/ttyUSB1 ping [text]
+#        proto_host.py /dev/ttyUSB1 led <number> <0|1>
+#        proto_host.py /dev/ttyUSB1 stats
+#
+# Sends a request and prints the reply. Packets are op, seq, payload
+# length (LE16), payload and CRC32 (LE32) - COBS encoded and ended with
+# a zero byte. The CRC is the one of the STM32 CRC unit, see
+# hal/src/crc_hal.c. The serial port is set to raw mode, set the baud
+# rate first, e.g. stty -F /dev/ttyUSB1 921600.
+#
+# Copyright (c) 2026 Michal Ksiezopolski.
+# All rights reserved. This program and the
+# accompanying materials are made available
+# under the terms of the GNU Public License
+# v3.0 which accompanies this distribution,
+# and is available at
+# http://www.gnu.org/licenses/gpl.html
+
+import os
+import select
+import struct
+import sys
+import tty
+
+OP_PING = 0x01          # must match proto.h
+OP_LED = 0x02
+OP_STATS = 0x03
+REPLY = 0x80
+MAX_PAYLOAD = 240
+DELIMITER = b'\0'
+
+STATUS = {0: 'OK', 1: 'unknown opcode', 2: 'invalid payload'}
+STATS = ('rxPackets', 'txPackets', 'crcErrors', 'frameErrors', 'txDropped')
+
+
+class ProtoError(Exception):
+    """Invalid packet received."""
+
+
+def cobs_encode(data):
+    """Returns data without zero bytes (delimiter not included)."""
+    out = bytearray()
+    block = bytearray()
+    for b in data:
+        if b == 0:
+            out += bytes([len(block) + 1]) + block
+            block = bytearray()
+        else:
+            block.append(b)
+            if len(block) == 254:  # maximum block length
+                out += b'\xff' + block
+                block = bytearray()
+    out += bytes([len(block) + 1]) + block
+    return bytes(out)
+
+
+def cobs_decode(data):
+    """Reverses cobs_encode."""
+    out = bytearray()
+    i = 0
+    while i < len(data):
+        code = data[i]
+        if code == 0 or i + code > len(data):
+            raise ProtoError('invalid COBS encoding')
+        out += data[i + 1:i + code]
+        i += code
+        if code != 0xFF and i < len(data):
+            out.append(0)
+    return bytes(out)
+
+
+def crc32_mpeg2(data):
+    """CRC-32/MPEG-2 (polynomial 0x04C11DB7, no reflection, no final XOR)."""
+    crc = 0xFFFFFFFF
+    for b in data:
+        crc ^= b << 24
+        for _ in range(8):
+            crc = (crc << 1) ^ 0x04C11DB7 if crc & 0x80000000 else crc << 1
+            crc &= 0xFFFFFFFF
+    return crc
+
+
+def crc32_stm32(data):
+    """CRC of the STM32 CRC unit - the last word is padded with zeros."""
+    return crc32_mpeg2(data + bytes(-len(data) % 4))
+
+
+def encode_packet(op, seq, payload=b''):
+    """Returns a packet ready to be sent (with delimiter)."""
+    if len(payload) > MAX_PAYLOAD:
+        raise ValueError('payload too long')
+    packet = struct.pack('<BBH', op, seq & 0xFF, len(payload)) + bytes(payload)
+    packet += struct.pack('<I', crc32_stm32(packet))
+    return cobs_encode(packet) + DELIMITER
+
+
+def decode_packet(frame):
+    """Returns (op, seq, payload) of a frame without delimiter."""
+    packet = cobs_decode(frame)
+    if len(packet) < 8:
+        raise ProtoError('packet too short')
+    op, seq, length = struct.unpack_from('<BBH', packet)
+    if length != len(packet) - 8:
+        raise ProtoError('wrong payload length')
+    crc, = struct.unpack_from('<I', packet, len(packet) - 4)
+    if crc != crc32_stm32(packet[:-4]):
+        raise ProtoError('wrong CRC')
+    return op, seq, packet[4:-4]
+
+
+class Link:
+    """Packet link over a file descriptor (serial port or pty)."""
+
+    def __init__(self, fd):
+        self.fd = fd
+        self.seq = 0
+        self.rx = b''
+
+    def send(self, op, payload=b''):
+        """Sends a request and returns its sequence number."""
+        self.seq = (self.seq + 1) & 0xFF
+        os.write(self.fd, encode_packet(op, self.seq, payload))
+        return self.seq
+
+    def receive(self, timeout=1.0):
+        """Returns the next frame (without delimiter) or None on timeout."""
+        while DELIMITER not in self.rx:
+            if not select.select([self.fd], [], [], timeout)[0]:
+                return None
+            self.rx += os.read(self.fd, 1024)
+        frame, self.rx = self.rx.split(DELIMITER, 1)
+        return frame
+
+    def request(self, op, payload=b'', timeout=1.0):
+        """Sends a request and returns the (op, payload) of its reply."""
+        seq = self.send(op, payload)
+        while True:
+            frame = self.receive(timeout)
+            if frame is None:
+                raise ProtoError('no reply')
+            if not frame:  # empty frames are used to resync
+                continue
+            rop, rseq, data = decode_packet(frame)
+            if rseq == seq:
+                return rop, data
+
+
+def main():
+    if len(sys.argv) < 3 or sys.argv[2] not in ('ping', 'led', 'stats'):
+        sys.exit('usage: proto_host.py port ping [text] | led <number> <0|1> | stats')
+    fd = os.open(sys.argv[1], os.O_RDWR | os.O_NOCTTY)
+    tty.setraw(fd)
+    link = Link(fd)
+    os.write(fd, DELIMITER)  # end any partial packet on the line
+    cmd = sys.argv[2]
+
+    try:
+        if cmd == 'ping':
+            payload = ' '.join(sys.argv[3:]).encode()
+            op, data = link.request(OP_PING, payload)
+            print('ping:', 'OK' if op == OP_PING | REPLY and data == payload else data)
+        elif cmd == 'led':
+            op, data = link.request(OP_LED, bytes([int(sys.argv[3]), int(sys.argv[4])]))
+            print('led:', STATUS.get(data[0], data[0]))
+        else:
+            op, data = link.request(OP_STATS)
+            for name, val in zip(STATS, struct.unpack('<%dI' % (len(data) // 4), data)):
+                print('%-12s %u' % (name, val))
+    except ProtoError as e:
+        sys.exit('error: %s' % e)
+
+
+if __name__ == '__main__':
+    main()
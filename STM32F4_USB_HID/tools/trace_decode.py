@@ -0,0 +1,109 @@
+#!/usr/bin/env python3
+#
+# @file    trace_decode.py
+# @brief   Decodes binary trace records (see app/inc/trace.h)
+# @date    17 paź 2026
+# @author  Michal Ksiezopolski
+#
+# Usage: trace_decode.py firmware.elf [/dev/ttyUSB0 | capture.bin]
+#
+# Reads the terminal output (stdin if no input is given), passes text
+# through and replaces trace records with text formatted using the
+# strings from the .trace_fmt section of the ELF file. Set up the
+# serial port first, e.g. stty -F /dev/ttyUSB0 115200 raw.
+#
+# Copyright (c) 2026 Michal Ksiezopolski.
+# All rights reserved. This program and the
+# accompanying materials are made available
+# under the terms of the GNU Public License
+# v3.0 which accompanies this distribution,
+# and is available at
+# http://www.gnu.org/licenses/gpl.html
+
+import re
+import struct
+import sys
+
+TRACE_SYNC = 0xF0      # must match trace.h
+TRACE_MAX_ARGS = 4
+
+CONVERSION = re.compile(r'%([-0]*)(\d*)l*([diuxXcs%])')
+
+
+def load_formats(path):
+    """Returns the .trace_fmt section of an ELF32 file."""
+    with open(path, 'rb') as f:
+        elf = f.read()
+    if elf[:4] != b'\x7fELF' or elf[4] != 1:
+        sys.exit('%s: not an ELF32 file' % path)
+    shoff, = struct.unpack_from('<I', elf, 0x20)
+    shentsize, shnum, shstrndx = struct.unpack_from('<HHH', elf, 0x2E)
+
+    def header(i):
+        return struct.unpack_from('<IIIIII', elf, shoff + i * shentsize)
+
+    strtab = header(shstrndx)[4]
+    for i in range(shnum):
+        name, _, _, _, offset, size = header(i)
+        end = elf.index(b'\0', strtab + name)
+        if elf[strtab + name:end] == b'.trace_fmt':
+            return elf[offset:offset + size]
+    sys.exit('%s: no .trace_fmt section' % path)
+
+
+def format_record(formats, fid, args):
+    """Formats a record like printf on the target would."""
+    if fid >= len(formats):
+        return '<unknown trace id %d>' % fid
+    fmt = formats[fid:formats.index(b'\0', fid)].decode('ascii', 'replace')
+    args = iter(args)
+
+    def convert(m):
+        flags, width, conv = m.groups()
+        if conv == '%':
+            return '%'
+        val = next(args, 0)
+        if conv in 'di' and val & 0x80000000:
+            val -= 1 << 32
+        if conv == 'c':
+            val = chr(val & 0xFF)
+        if conv == 's':  # pointers mean nothing on the host
+            return '<str>'
+        return ('%' + flags + width + conv.replace('i', 'd')) % val
+
+    return CONVERSION.sub(convert, fmt)
+
+
+def main():
+    if len(sys.argv) < 2:
+        sys.exit('usage: trace_decode.py firmware.elf [input]')
+    formats = load_formats(sys.argv[1])
+    src = open(sys.argv[2], 'rb', buffering=0) if len(sys.argv) > 2 else sys.stdin.buffer
+    out = sys.stdout
+
+    def read(n):
+        data = b''
+        while len(data) < n:
+            chunk = src.read(n - len(data))
+            if not chunk:
+                raise EOFError
+            data += chunk
+        return data
+
+    try:
+        while True:
+            c = read(1)[0]
+            argc = c - TRACE_SYNC
+            if 0 <= argc <= TRACE_MAX_ARGS:
+                fid, time = struct.unpack('<HI', read(6))
+                args = struct.unpack('<%dI' % argc, read(4 * argc))
+                out.write('[%10u] %s\n' % (time, format_record(formats, fid, args)))
+            elif c < 0x80:
+                out.write(chr(c))
+            out.flush()
+    except (EOFError, KeyboardInterrupt):
+        pass
+
+
+if __name__ == '__main__':
+    main()